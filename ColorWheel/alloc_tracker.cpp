@@ -0,0 +1,110 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+// NOTE: Kept in its own translation unit so the replacements are never inlined into callers.
+
+#include <cstdlib>
+#include <new>
+
+#include "alloc_tracker.hpp"
+
+
+#if COLORWHEEL_ALLOC_TRACKING
+
+namespace
+{
+
+    // Plain integers; only their own thread ever touches them.
+    thread_local std::uint64_t threadAllocations = 0u;
+    thread_local std::uint64_t threadBytes = 0u;
+
+} // namespace
+
+
+namespace alloc_tracker
+{
+
+    Counts ThreadCounts() noexcept
+    {
+        return Counts { threadAllocations, threadBytes };
+    }
+
+} // namespace alloc_tracker
+
+
+void* operator new(std::size_t size)
+{
+    ++threadAllocations;
+    threadBytes += size;
+    if (void* const p = std::malloc(0u != size ? size : 1u))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return ::operator new(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#else
+
+namespace alloc_tracker
+{
+
+    Counts ThreadCounts() noexcept
+    {
+        return Counts { 0u, 0u };
+    }
+
+} // namespace alloc_tracker
+
+#endif
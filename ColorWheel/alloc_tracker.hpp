@@ -0,0 +1,56 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <cstdint>
+
+// Define COLORWHEEL_ALLOC_TRACKING as 0 to keep the standard global allocation functions; every
+// count then reads 0.
+#ifndef COLORWHEEL_ALLOC_TRACKING
+#define COLORWHEEL_ALLOC_TRACKING 1
+#endif
+
+
+// Heap allocation counting
+///////////////////////////
+// Replaces the global operator new and delete with versions that count, per thread, every
+// allocation made through them. Only operator new is seen; memory SDL, OpenGL drivers, or the C
+// library get from malloc() directly isn't. Counting costs a thread-local increment, and never
+// locks or allocates itself.
+namespace alloc_tracker
+{
+
+    struct Counts
+    {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+    };
+
+    // Returns: the totals of every allocation the calling thread has made.
+    Counts ThreadCounts() noexcept;
+
+    // Counts the allocations the calling thread makes from construction on.
+    class Scope
+    {
+    public:
+        Scope() noexcept
+            : _start(ThreadCounts())
+        {
+        }
+
+        Counts Elapsed() const noexcept
+        {
+            const auto now = ThreadCounts();
+            return Counts { now.allocations - _start.allocations, now.bytes - _start.bytes };
+        }
+
+    private:
+        const Counts _start;
+    };
+
+} // namespace alloc_tracker
+
+
+#endif
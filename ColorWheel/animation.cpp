@@ -0,0 +1,127 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "animation.hpp"
+
+
+void SplitLevel(const float level, int& power, float& blendT) noexcept
+{
+    power = static_cast<int>(std::ceil(level));
+    blendT = level - static_cast<float>(power) + 1.0f;
+}
+
+
+const double Animator::StepMilliseconds = 1.0;
+const double Animator::MaxAdvanceMilliseconds = 250.0;
+
+Animator::Animator() noexcept
+    : _tweenCount(0u)
+    , _accumulatedMilliseconds(0.0)
+    , _changed((1u << ChannelCount) - 1u)
+    , _finished(0u)
+{
+    _values.fill(0.0f);
+}
+
+void Animator::Set(const AnimationChannel channel, const float value) noexcept
+{
+    const auto pTween = Find(channel);
+    if (nullptr != pTween)
+    {
+        Remove(pTween);
+    }
+
+    if (value != _values[Index(channel)])
+    {
+        _values[Index(channel)] = value;
+        _changed |= Bit(channel);
+    }
+}
+
+void Animator::AnimateTo(const AnimationChannel channel, const float target, const float rate) noexcept
+{
+    auto pTween = Find(channel);
+    if (nullptr == pTween)
+    {
+        if (target == _values[Index(channel)])
+        {
+            return;
+        }
+
+        pTween = &_tweens[_tweenCount++];
+        pTween->channel = channel;
+    }
+
+    pTween->target = target;
+    pTween->rate = std::abs(rate);
+}
+
+bool Animator::IsAnimating(const AnimationChannel channel) const noexcept
+{
+    return _tweens.begin() + _tweenCount != std::find_if(
+        _tweens.begin(),
+        _tweens.begin() + _tweenCount,
+        [channel](const Tween& tween) { return channel == tween.channel; }
+        );
+}
+
+void Animator::Advance(const double elapsedMilliseconds) noexcept
+{
+    if (0u == _tweenCount)
+    {
+        // Idle time isn't banked; a new tween starts from rest.
+        _accumulatedMilliseconds = 0.0;
+        return;
+    }
+
+    _accumulatedMilliseconds = std::min(
+        _accumulatedMilliseconds + std::max(elapsedMilliseconds, 0.0),
+        MaxAdvanceMilliseconds
+        );
+
+    const auto Step = static_cast<float>(StepMilliseconds);
+    while (_accumulatedMilliseconds >= StepMilliseconds && 0u != _tweenCount)
+    {
+        _accumulatedMilliseconds -= StepMilliseconds;
+
+        for (std::size_t i = 0u; i < _tweenCount;)
+        {
+            auto& tween = _tweens[i];
+            auto& value = _values[Index(tween.channel)];
+            const auto delta = tween.rate * Step;
+
+            _changed |= Bit(tween.channel);
+
+            if (std::abs(tween.target - value) <= delta)
+            {
+                value = tween.target;
+                _finished |= Bit(tween.channel);
+                Remove(&tween);     // The last tween moves into slot i.
+                continue;
+            }
+
+            value += (tween.target > value) ? delta : -delta;
+            ++i;
+        }
+    }
+}
+
+Animator::Tween* Animator::Find(const AnimationChannel channel) noexcept
+{
+    for (std::size_t i = 0u; i < _tweenCount; ++i)
+    {
+        if (channel == _tweens[i].channel)
+        {
+            return &_tweens[i];
+        }
+    }
+    return nullptr;
+}
+
+void Animator::Remove(Tween* const pTween) noexcept
+{
+    *pTween = _tweens[--_tweenCount];
+}
@@ -0,0 +1,124 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef ANIMATION
+#define ANIMATION
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+// The animated values of the color wheel.
+enum class AnimationChannel
+    : std::size_t
+{
+    ColorBlend,         // RGB (0) to RYB (1) color model.
+    ColorSpaceBlend,    // From the current (0) to the next (1) color space.
+    InnerRadius,        // Fraction of the wheel's inner radius; 0 for the HSL and HSV discs.
+    SectorBlend,        // Hue tessellation level; see SplitLevel().
+    TrackBlend,         // Saturation tessellation level; see SplitLevel().
+    ConeScale,          // Scale of the HSL bi-cone, or HSV cone, slice.
+
+    Count
+};
+
+// Splits a tessellation level into the power of the mesh to build and its blend factor. Between
+// whole levels the mesh has the higher level's sectors (or tracks), with the new ones partially
+// blended in; at a whole level the blend is 1.
+void SplitLevel(const float level, int& power, float& blendT) noexcept;
+
+// Tween engine
+///////////////
+// Every running tween lives in one small flat array, and they're all advanced together in fixed
+// time steps, so animation speed doesn't depend on the frame rate. A tween moves its channel's value
+// toward a target at a constant rate, and stops there.
+//
+// Changes accumulate until ClearChanges(): HasChanged() reports which values moved, so only what
+// depends on them has to be updated, and HasFinished() which tweens reached their targets. Every
+// channel starts out changed, so the first frame applies them all.
+class Animator
+{
+public:
+    static const std::size_t ChannelCount = static_cast<std::size_t>(AnimationChannel::Count);
+
+    // Length of one simulation step, in milliseconds.
+    static const double StepMilliseconds;
+
+    // Time an Advance() may simulate at most; a stalled frame doesn't fast-forward everything.
+    static const double MaxAdvanceMilliseconds;
+
+    Animator() noexcept;
+
+    float Value(const AnimationChannel channel) const noexcept
+    {
+        return _values[Index(channel)];
+    }
+
+    // Jumps to value, and stops any tween of the channel.
+    void Set(const AnimationChannel channel, const float value) noexcept;
+
+    // Moves the channel toward target at rate (units per millisecond). A running tween of the
+    // channel is retargeted; nothing starts if the value is already at target.
+    void AnimateTo(const AnimationChannel channel, const float target, const float rate) noexcept;
+
+    bool IsAnimating(const AnimationChannel channel) const noexcept;
+
+    bool IsAnimating() const noexcept
+    {
+        return 0u != _tweenCount;
+    }
+
+    // Simulates elapsed milliseconds of every running tween, in whole steps; the remainder carries
+    // over to the next call.
+    void Advance(const double elapsedMilliseconds) noexcept;
+
+    bool HasChanged(const AnimationChannel channel) const noexcept
+    {
+        return 0u != (_changed & Bit(channel));
+    }
+
+    bool HasFinished(const AnimationChannel channel) const noexcept
+    {
+        return 0u != (_finished & Bit(channel));
+    }
+
+    void ClearChanges() noexcept
+    {
+        _changed = 0u;
+        _finished = 0u;
+    }
+
+private:
+    struct Tween
+    {
+        AnimationChannel    channel;
+        float               target;
+        float               rate;
+    };
+
+    static std::size_t Index(const AnimationChannel channel) noexcept
+    {
+        return static_cast<std::size_t>(channel);
+    }
+
+    static std::uint32_t Bit(const AnimationChannel channel) noexcept
+    {
+        return 1u << Index(channel);
+    }
+
+    // Returns: the channel's tween, or nullptr.
+    Tween* Find(const AnimationChannel channel) noexcept;
+
+    void Remove(Tween* const pTween) noexcept;
+
+    std::array<float, ChannelCount> _values;
+    std::array<Tween, ChannelCount> _tweens;
+    std::size_t _tweenCount;
+    double _accumulatedMilliseconds;
+    std::uint32_t _changed;
+    std::uint32_t _finished;
+};
+
+
+#endif
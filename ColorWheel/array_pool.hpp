@@ -0,0 +1,74 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef ARRAY_POOL
+#define ARRAY_POOL
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+// Recycles shared arrays
+/////////////////////////
+// Hands out arrays that nothing else references, so a generator can refill one instead of
+// allocating a new one. An array is free again once every other shared_ptr to it is gone, whatever
+// thread releases them. Once the pool holds as many arrays as are ever in use at once, each at the
+// largest size asked for, Acquire() no longer allocates.
+// NOTE: Only one thread may call Acquire().
+template<typename T>
+class ArrayPool
+{
+public:
+    typedef std::shared_ptr<std::vector<T>> pointer;
+
+    ArrayPool() noexcept
+        : _growthCount(0u)
+    {
+    }
+
+    // Returns: an array of size elements that nothing else references; its contents are left over
+    //          from its last use.
+    // Throws:  std::bad_alloc
+    pointer Acquire(const std::size_t size)
+    {
+        for (const auto& pArray : _arrays)
+        {
+            if (1 == pArray.use_count())
+            {
+                // Pairs with the release of the last other reference, which may have been on
+                // another thread, so its reads of the old contents happen before they're refilled.
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (pArray->capacity() < size)
+                {
+                    ++_growthCount;
+                }
+                pArray->resize(size);
+                return pArray;
+            }
+        }
+
+        ++_growthCount;
+        _arrays.push_back(std::make_shared<std::vector<T>>(size));
+        return _arrays.back();
+    }
+
+    // Returns: how many times Acquire() has had to allocate.
+    std::size_t GrowthCount() const noexcept
+    {
+        return _growthCount;
+    }
+
+    // Not copyable.
+    ArrayPool(const ArrayPool&) = delete;
+    ArrayPool& operator =(const ArrayPool&) = delete;
+
+private:
+    std::vector<pointer> _arrays;
+    std::size_t _growthCount;
+};
+
+
+#endif
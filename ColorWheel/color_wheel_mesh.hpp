@@ -0,0 +1,299 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef COLOR_WHEEL_MESH_HPP
+#define COLOR_WHEEL_MESH_HPP
+
+// Color wheel mesh and color generation.
+// NOTE: Nothing in here depends on OpenGL, so it can be built and benchmarked without a window
+// or GL context (see: bench/).
+
+#include <cassert>
+#include <cstddef>
+#include <cmath>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "trig_constants.h"
+#include "math_utils.h"
+
+
+const auto MinHues = 6;
+const auto MinSaturations = 2;
+
+const auto MaxHueTessellations = 7;
+const auto MaxSaturationTessellations = 8;
+const auto WheelInnerRadius = 0.5f;
+
+const double RgbColorModel[] =
+{
+    1.0, 0.0, 0.0, // Red
+    //1.0, 0.5, 0.0, // Orange
+    1.0, 1.0, 0.0, // Yellow
+    //0.5, 1.0, 0.0, // Chartreuse
+    0.0, 1.0, 0.0, // Green
+    //0.0, 1.0, 0.5, // Spring
+    0.0, 1.0, 1.0, // Cyan
+    //0.0, 0.5, 1.0, // Azure
+    0.0, 0.0, 1.0, // Blue
+    //0.5, 0.0, 1.0, // Violet
+    1.0, 0.0, 1.0, // Magenta
+    //1.0, 0.0, 0.5, // Rose
+};
+
+const double RybColorModel[] = // RYB
+{
+    double(0xfe) / 0xff, double(0x27) / 0xff, double(0x12) / 0xff, // Red
+    double(0xfb) / 0xff, double(0x99) / 0xff, double(0x02) / 0xff, // Orange
+    double(0xfe) / 0xff, double(0xfe) / 0xff, double(0x33) / 0xff, // Yellow
+    double(0x66) / 0xff, double(0xb0) / 0xff, double(0x32) / 0xff, // Green
+    double(0x02) / 0xff, double(0x47) / 0xff, double(0xfe) / 0xff, // Blue
+    double(0x86) / 0xff, double(0x01) / 0xff, double(0xaf) / 0xff, // Violet
+};
+
+
+template<size_t ColorModelSize>
+void CalculateHueForColorModel(
+    const double hueRadians,
+    const double (&colorModel)[ColorModelSize],
+    glm::dvec3& color
+    )
+{
+    using namespace trig;
+    static_assert(0 != ColorModelSize, "ColorModelSize == 0");
+
+    const int ColorCount = ColorModelSize / 3;
+    assert(0 != ColorCount);
+
+    const double ColorRange = TwoPi / ColorCount;
+    const double clampedHue = ClampRadians(hueRadians);
+
+    const int lowerColor = (int(clampedHue / ColorRange) >= ColorCount) ?
+        ColorCount - 1 : int(clampedHue / ColorRange);
+    const int upperColor = (lowerColor + 1 >= ColorCount) ? 0 : lowerColor + 1;
+
+    const double distFromLower = clampedHue - (lowerColor * ColorRange);
+
+    const double upperContribution = distFromLower / ColorRange;
+    const double lowerContribution = 1.0 - upperContribution;
+
+    const int i = lowerColor * 3;
+    const int j = upperColor * 3;
+    color.r = (lowerContribution * colorModel[i + 0]) + (upperContribution * colorModel[j + 0]);
+    color.g = (lowerContribution * colorModel[i + 1]) + (upperContribution * colorModel[j + 1]);
+    color.b = (lowerContribution * colorModel[i + 2]) + (upperContribution * colorModel[j + 2]);
+}
+
+
+// Must make sure there's room reserved for (colorCount * 4) additional glm::vec3s.
+//      colorWheelColors.reserve(colorWheelColors.size() + (colorCount * 4));
+// Returns: iterator pointing to end()
+template<
+    typename iterator_type,
+    typename std::enable_if<
+        std::is_same<typename std::iterator_traits<iterator_type>::value_type, glm::vec3>::value
+        >::type* = nullptr
+    >
+iterator_type CreateColorWheelColors(
+    const unsigned int colorCount,
+    const unsigned int trackCount,
+    const double (&colorModel)[3 * 6],
+    const iterator_type position
+    )
+{
+    const auto SliceStep = trig::TwoPi / static_cast<decltype(trig::TwoPi)>(colorCount);
+
+    auto it = position;
+    auto hue = 0.0;
+    glm::dvec3 color;
+
+    for (auto j = 0; j < colorCount; ++j, hue += SliceStep)
+    {
+        CalculateHueForColorModel(hue, colorModel, color);
+
+        // 4 points per quad
+        for (auto i = 0; i < 4; ++i, ++it)
+        {
+            *it = color;
+        }
+    }
+
+    // Copy the colors of the first track to all the rest.
+    for (auto j = 1; j < trackCount; ++j)
+    {
+        auto srcIt = position;
+        for (auto i = 0; i < colorCount * 4; ++i, ++srcIt, ++it)
+        {
+            *it = *srcIt;
+        }
+    }
+
+    return it;
+}
+
+
+// Must make sure there's room reserved for (trackCount * sectorCount * 4) additional glm::vec2s.
+//      colorWheelVerts.reserve(colorWheelVerts.size() + (trackCount * sectorCount * 4));
+// Returns: iterator pointing to end()
+template<
+    typename iterator_type,
+    typename std::enable_if<
+        std::is_same<typename std::iterator_traits<iterator_type>::value_type, glm::vec2>::value
+        >::type* = nullptr
+    >
+iterator_type CreateColorWheelGeometry(
+    const unsigned int  sectorCount,
+    const unsigned int  trackCount,
+    const float         innerRadius,        // inner radius of the color wheel
+    const float         sectorBlendT,
+    const float         trackBlendT,
+    const iterator_type position
+    )
+{
+    assert(sectorCount >= 2);
+    assert(sectorCount % 2 == 0);
+    assert(trackCount == 1 || trackCount % 2 == 0);
+
+    const auto SliceStep = trig::TwoPi / sectorCount; // Radians of a single slice.
+    const auto SectorHalfBlend = sectorBlendT / 2.0; // Clamp sector blend from [0.0, 0.5].
+    // Blend even slice half-size from [1.0, 0.5].
+    const auto EvenSectorHalfAngle = SliceStep * (1.0 - SectorHalfBlend);
+    // Blend odd slice half-size from [0.0, 0.5].
+    const auto OddSectorHalfAngle = SliceStep * SectorHalfBlend;
+
+    // Width of a single track.
+    const auto TrackStep = (trackCount > 0) ? (1.0 - innerRadius) / trackCount : 1.0 - innerRadius;
+    // Blend even track width from double track to single track width.
+    const auto EvenTrackWidth = TrackStep + TrackStep * (1.0 - trackBlendT);
+    // Blend odd track width from [0.0, 1.0].
+    const auto OddTrackWidth = TrackStep * trackBlendT;
+    const auto minTracks = (0 != trackCount) ? trackCount : 1;
+
+    auto it = position;
+    auto trackInnerRadius = innerRadius;
+    auto isEvenTrack = true;
+
+    for (auto j = 0; j < minTracks; j += 2)
+    {
+        for (auto k = 0; k < 2; ++k)
+        {
+            const auto              Inner = trackInnerRadius;
+            const decltype(Inner)   Outer = Inner + ((isEvenTrack) ? EvenTrackWidth : OddTrackWidth);
+
+            auto sectorAngle = 0.0;
+
+            for (auto l = 0; l < sectorCount; l += 2)
+            {
+                auto isEvenSector = true;
+                
+                for (auto m = 0; m < 2; ++m)
+                {
+                    const auto SectorHalfAngle = (isEvenSector) ?
+                        EvenSectorHalfAngle : OddSectorHalfAngle;
+                    const auto lower = sectorAngle - SectorHalfAngle;
+                    const auto upper = sectorAngle + SectorHalfAngle;
+                    const auto lr = glm::vec2(std::cos(lower), std::sin(lower));
+                    const auto ur = glm::vec2(std::cos(upper), std::sin(upper));
+
+                    *it++ = lr * Inner;
+                    *it++ = lr * Outer;
+                    *it++ = ur * Inner;
+                    *it++ = ur * Outer;
+
+                    sectorAngle += SliceStep;
+
+                    isEvenSector = !isEvenSector;
+                }
+            }
+
+            trackInnerRadius = Outer;
+
+            isEvenTrack = !isEvenTrack;
+        }
+    }
+
+    return it;
+}
+
+
+template<
+    typename iterator_type,
+    typename std::enable_if<
+        std::is_same<typename std::iterator_traits<iterator_type>::value_type, float>::value
+        >::type* = nullptr
+    >
+iterator_type CreateColorWheelSaturation(
+    const unsigned int  sectorCount,
+    const unsigned int  trackCount,
+    const float         trackBlendT,
+    const iterator_type position
+    )
+{
+    assert(trackCount == 1 || trackCount % 2 == 0);
+
+    // Relative width of a single track for a unit circle.
+    const auto TrackStep = (trackCount > 0) ? 1.0 / trackCount : 1.0;
+    // Blend even track width from double track to single track width.
+    const auto EvenTrackWidth = TrackStep + TrackStep * (1.0 - trackBlendT);
+    // Blend odd track width from [0.0, 1.0].
+    const auto OddTrackWidth = TrackStep * trackBlendT;
+    const auto minTracks = (0 != trackCount) ? trackCount : 1;
+
+    auto it = position;
+    auto trackInnerRadius = 0.0f;
+    auto isEven = trackCount >= 2;
+
+    for (auto j = 0; j < minTracks; ++j)
+    {
+        const float Outer = trackInnerRadius + (isEven ? EvenTrackWidth : OddTrackWidth);
+        isEven = !isEven;
+
+        for (auto k = 0; k < sectorCount; ++k)
+        {
+            for (auto l = 0; l < 4; ++l)
+            {
+                *it++ = Outer; // Change to Inner for smooth shading.
+            }
+        }
+
+        trackInnerRadius = Outer;
+    }
+
+    return it;
+}
+
+
+// 6, 12, 24, 48, 96, 192, 384
+inline constexpr int ColorCountForTessellation(const int divisions)
+{
+    return MinHues * (1 << divisions);
+}
+
+
+inline constexpr int SaturationCountForTessellation(const int divisions)
+{
+    return 2 << divisions;
+}
+
+
+inline void RecalculateIndices(
+    const unsigned int      sectorCount,
+    const unsigned int      trackCount,
+    std::vector<int>&       trackStartPositions,   // Matches std::vector<GLint>.
+    std::vector<int>&       trackIndiceCounts      // Matches std::vector<GLsizei>.
+    )
+{
+    const auto minTracks = (0 != trackCount) ? trackCount : 1;
+    const auto ElementsPerTrack = sectorCount * 4;
+    auto startPosition = 0;
+
+    for (auto i = 0; i < minTracks; ++i, startPosition += ElementsPerTrack)
+    {
+        trackStartPositions[i] = startPosition;
+        trackIndiceCounts[i] = ElementsPerTrack;
+    }
+}
+
+
+#endif
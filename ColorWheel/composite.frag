@@ -0,0 +1,14 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+
+#version 150 core
+
+uniform sampler2D sourceTexture;
+
+in vec2 thru_texCoord;
+
+out vec4 out_color;
+
+void main()
+{
+    out_color = texture(sourceTexture, thru_texCoord);
+}
@@ -0,0 +1,14 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+
+#version 150 core
+
+out vec2 thru_texCoord;
+
+// Emits a full-viewport triangle strip from the vertex index alone; no vertex buffers are needed.
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+
+    thru_texCoord = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,39 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <cstring>
+
+#include <opengl/gl3.h>         // Probably specific to OS X.
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>          // Vector and Matrix math.
+
+#include "frame_packet.hpp"
+
+
+void FramePacket::CopyGui(const imguiGfxCmd* const pCommands, const int count)
+{
+    guiCommands.assign(pCommands, pCommands + count);
+
+    // All of the text is reserved up front, so appending never moves what's already pointed to.
+    std::size_t textSize = 0u;
+    for (const auto& command : guiCommands)
+    {
+        if (IMGUI_GFXCMD_TEXT == command.type)
+        {
+            textSize += std::strlen(command.text.text) + 1u;
+        }
+    }
+
+    guiText.clear();
+    guiText.reserve(textSize);
+
+    for (auto& command : guiCommands)
+    {
+        if (IMGUI_GFXCMD_TEXT == command.type)
+        {
+            const auto offset = guiText.size();
+            guiText.insert(guiText.end(), command.text.text, command.text.text + std::strlen(command.text.text) + 1u);
+            command.text.text = &guiText[offset];
+        }
+    }
+}
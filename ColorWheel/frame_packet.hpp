@@ -0,0 +1,84 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef FRAME_PACKET
+#define FRAME_PACKET
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "imgui/imgui.h"
+#include "frame_timing.hpp"
+
+
+// The wheel's vertex data, as generated by the game loop. Each array is shared, and never modified
+// once it's been published; an array that didn't change is handed from frame to frame as is, and
+// the renderer only uploads arrays it hasn't seen.
+struct WheelMesh
+{
+    std::shared_ptr<const std::vector<GLint>>       pTrackStarts;   // Per-track triangle strip ranges.
+    std::shared_ptr<const std::vector<GLsizei>>     pTrackCounts;
+    std::shared_ptr<const std::vector<GLfloat>>     pSaturation;
+    std::shared_ptr<const std::vector<glm::vec3>>   pColors;
+    std::shared_ptr<const std::vector<glm::vec3>>   pAltColors;
+    std::shared_ptr<const std::vector<glm::vec2>>   pVertices;
+    unsigned int                                    trackCount;
+};
+
+// The wheel shader's uniform values.
+struct WheelUniforms
+{
+    GLfloat colorBlendT;
+    GLint   colorSpace0;
+    GLint   colorSpace1;
+    GLfloat colorSpaceBlendT;
+    GLfloat lightness;
+    GLfloat value;
+    GLfloat coneScale;
+};
+
+// Everything needed to draw one frame, published by the game loop to the renderer.
+//
+// NOTE: Not copyable; the GUI commands point into the packet's own text.
+struct FramePacket
+{
+    // imgui's initial queue and text chunk sizes; a larger GUI grows each packet's copy once, as it
+    // grows imgui's own arenas.
+    static const std::size_t GuiCommandCapacity = 1024u;
+    static const std::size_t GuiTextCapacity = 8192u;
+    // Refilling a packet only allocates while more input is pending than this.
+    static const std::size_t InputTimeCapacity = 1024u;
+
+    // Throws:  std::bad_alloc
+    FramePacket()
+        : number(0u)
+    {
+        inputTimes.reserve(InputTimeCapacity);
+        guiCommands.reserve(GuiCommandCapacity);
+        guiText.reserve(GuiTextCapacity);
+    }
+
+    // Copies imgui's render queue, and the text it points to.
+    // Throws:  std::bad_alloc
+    void CopyGui(const imguiGfxCmd* const pCommands, const int count);
+
+    std::uint64_t                       number;
+
+    // When each input event this frame reflects happened, oldest first. Events stay in later
+    // packets until a frame showing them has been drawn; the renderer only measures the latency of
+    // events newer than the last one it measured.
+    std::vector<FrameTimings::clock::time_point>    inputTimes;
+
+    WheelUniforms                       uniforms;
+    WheelMesh                           mesh;
+
+    std::vector<imguiGfxCmd>            guiCommands;
+    std::vector<char>                   guiText;
+
+    // Not copyable.
+    FramePacket(const FramePacket&) = delete;
+    FramePacket& operator =(const FramePacket&) = delete;
+};
+
+
+#endif
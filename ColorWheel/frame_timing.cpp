@@ -0,0 +1,325 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+
+#include <opengl/gl3.h>         // Probably specific to OS X.
+
+#include "imgui/imgui.h"
+#include "gl_query.hpp"
+
+#include "frame_timing.hpp"
+
+
+namespace
+{
+
+    double ToMilliseconds(const FrameTimings::clock::duration elapsed) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    // Formats "min/avg/p99", or dashes when nothing has been measured.
+    void FormatStatistics(const TimingStatistics& statistics, char* const text, const std::size_t size)
+    {
+        if (0u == statistics.samples)
+        {
+            std::snprintf(text, size, "     -/     -/     -");
+            return;
+        }
+
+        std::snprintf(
+            text,
+            size,
+            "%6.2f/%6.2f/%6.2f",
+            statistics.minimum,
+            statistics.average,
+            statistics.p99
+            );
+    }
+
+    const char StatisticsHeading[] = "ms (min/avg/p99)           CPU                     GPU";
+
+    // The input latency rows' CPU column is the time until the swap returned, and their GPU column
+    // is the time until the fence after it was signaled.
+    const char InputLatencyLabel[] = "Input to swap";
+    const char InputPercentilesLabel[] = "  (p50/p90/p99.9)";
+
+    TimingStatistics ToStatistics(const LatencyHistogram& histogram) noexcept
+    {
+        return TimingStatistics {
+            histogram.Minimum() / 1000.0,
+            histogram.Mean() / 1000.0,
+            histogram.ValueAtPercentile(99.0) / 1000.0,
+            static_cast<std::size_t>(histogram.Count())
+        };
+    }
+
+    // Formats "p50/p90/p99.9", or dashes when nothing has been measured.
+    void FormatPercentiles(const LatencyHistogram& histogram, char* const text, const std::size_t size)
+    {
+        if (0u == histogram.Count())
+        {
+            std::snprintf(text, size, "     -/     -/     -");
+            return;
+        }
+
+        std::snprintf(
+            text,
+            size,
+            "%6.2f/%6.2f/%6.2f",
+            histogram.ValueAtPercentile(50.0) / 1000.0,
+            histogram.ValueAtPercentile(90.0) / 1000.0,
+            histogram.ValueAtPercentile(99.9) / 1000.0
+            );
+    }
+
+    // Formats one row of the statistics table.
+    void FormatStageLine(
+        const char* const label,
+        const TimingStatistics& cpuStatistics,
+        const TimingStatistics& gpuStatistics,
+        char* const text,
+        const std::size_t size
+        )
+    {
+        char cpu[32];
+        FormatStatistics(cpuStatistics, cpu, sizeof(cpu));
+
+        char gpu[32];
+        FormatStatistics(gpuStatistics, gpu, sizeof(gpu));
+
+        std::snprintf(text, size, "%-18s %s   %s", label, cpu, gpu);
+    }
+
+    // Formats the percentiles row under the input latency row.
+    void FormatPercentilesLine(
+        const LatencyHistogram& swapLatency,
+        const LatencyHistogram& fenceLatency,
+        char* const text,
+        const std::size_t size
+        )
+    {
+        char swap[32];
+        FormatPercentiles(swapLatency, swap, sizeof(swap));
+
+        char fence[32];
+        FormatPercentiles(fenceLatency, fence, sizeof(fence));
+
+        std::snprintf(text, size, "%-18s %s   %s", InputPercentilesLabel, swap, fence);
+    }
+
+} // namespace
+
+
+const char* ToString(const FrameStage stage) noexcept
+{
+    switch (stage)
+    {
+        case FrameStage::Frame:
+            return "Frame";
+        case FrameStage::MeshGeneration:
+            return "Mesh generation";
+        case FrameStage::Upload:
+            return "Upload";
+        case FrameStage::WheelDraw:
+            return "Wheel draw";
+        case FrameStage::Gui:
+            return "GUI";
+        default:
+            break;
+    }
+    return "Unknown";
+}
+
+
+TimingStatistics TimingHistory::Statistics() const noexcept
+{
+    TimingStatistics result { 0.0, 0.0, 0.0, _count };
+    if (0u == _count)
+    {
+        return result;
+    }
+
+    // The window is small; sorting a copy is cheaper than maintaining an order statistic tree.
+    std::array<double, Capacity> sorted;
+    std::copy(_samples.begin(), _samples.begin() + _count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + _count);
+
+    double sum = 0.0;
+    for (std::size_t i = 0u; i < _count; ++i)
+    {
+        sum += sorted[i];
+    }
+
+    const auto p99Index = static_cast<std::size_t>(std::ceil(0.99 * _count)) - 1u;
+
+    result.minimum = sorted[0];
+    result.average = sum / _count;
+    result.p99 = sorted[p99Index];
+    return result;
+}
+
+
+FrameTimings::FrameTimings()
+    : _lastFrameMilliseconds(0.0)
+    , _hasFrameStarted(false)
+    , _isOverlayVisible(false)
+{
+    _cpuThisFrame.fill(clock::duration::zero());
+}
+
+FrameTimings::~FrameTimings()
+{
+}
+
+void FrameTimings::BeginFrame() noexcept
+{
+    const auto now = clock::now();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_hasFrameStarted)
+    {
+        _cpuThisFrame[static_cast<std::size_t>(FrameStage::Frame)] = now - _frameStart;
+        _lastFrameMilliseconds = ToMilliseconds(now - _frameStart);
+
+        for (std::size_t i = 0u; i < StageCount; ++i)
+        {
+            _cpuHistory[i].Add(ToMilliseconds(_cpuThisFrame[i]));
+        }
+    }
+
+    _cpuThisFrame.fill(clock::duration::zero());
+    _frameStart = now;
+    _hasFrameStarted = true;
+}
+
+void FrameTimings::CollectGpuTimes() noexcept
+{
+    // Stages without GPU work never have pending queries, and never get samples.
+    for (std::size_t i = 0u; i < StageCount; ++i)
+    {
+        GLuint64 nanoseconds = 0u;
+        while (_gpuQueries[i].Collect(nanoseconds))
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _gpuHistory[i].Add(static_cast<double>(nanoseconds) / 1.0e6);
+        }
+    }
+}
+
+void FrameTimings::AddInputLatency(const clock::duration latency) noexcept
+{
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _swapLatency.Record(static_cast<std::uint64_t>(std::max<std::int64_t>(microseconds, 0)));
+}
+
+void FrameTimings::AddFencedInputLatency(const clock::duration latency) noexcept
+{
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _fenceLatency.Record(static_cast<std::uint64_t>(std::max<std::int64_t>(microseconds, 0)));
+}
+
+TimingStatistics FrameTimings::InputLatencyStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return ToStatistics(_swapLatency);
+}
+
+TimingStatistics FrameTimings::FencedInputLatencyStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return ToStatistics(_fenceLatency);
+}
+
+void FrameTimings::BeginGpu(const FrameStage stage)
+{
+    _gpuQueries[static_cast<std::size_t>(stage)].Begin();
+}
+
+void FrameTimings::EndGpu(const FrameStage stage)
+{
+    _gpuQueries[static_cast<std::size_t>(stage)].End();
+}
+
+void FrameTimings::DrawOverlay(const int x, const int y) const
+{
+    if (!_isOverlayVisible)
+    {
+        return;
+    }
+
+    const auto LineHeight = 20;
+    const auto Color = imguiRGBA(255, 255, 192, 224);
+
+    ::imguiDrawText(x, y, IMGUI_ALIGN_LEFT, StatisticsHeading, Color);
+
+    for (std::size_t i = 0u; i < StageCount; ++i)
+    {
+        const auto stage = static_cast<FrameStage>(i);
+
+        char text[128];
+        FormatStageLine(ToString(stage), CpuStatistics(stage), GpuStatistics(stage), text, sizeof(text));
+        ::imguiDrawText(x, y - LineHeight * static_cast<int>(i + 1u), IMGUI_ALIGN_LEFT, text, Color);
+    }
+
+    char text[128];
+    FormatStageLine(InputLatencyLabel, InputLatencyStatistics(), FencedInputLatencyStatistics(), text, sizeof(text));
+    ::imguiDrawText(x, y - LineHeight * static_cast<int>(StageCount + 1u), IMGUI_ALIGN_LEFT, text, Color);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        FormatPercentilesLine(_swapLatency, _fenceLatency, text, sizeof(text));
+    }
+    ::imguiDrawText(x, y - LineHeight * static_cast<int>(StageCount + 2u), IMGUI_ALIGN_LEFT, text, Color);
+}
+
+void FrameTimings::WriteStatistics(std::ostream& stream) const
+{
+    stream << StatisticsHeading << std::endl;
+
+    for (std::size_t i = 0u; i < StageCount; ++i)
+    {
+        const auto stage = static_cast<FrameStage>(i);
+
+        char text[128];
+        FormatStageLine(ToString(stage), CpuStatistics(stage), GpuStatistics(stage), text, sizeof(text));
+        stream << text << std::endl;
+    }
+
+    char text[128];
+    FormatStageLine(InputLatencyLabel, InputLatencyStatistics(), FencedInputLatencyStatistics(), text, sizeof(text));
+    stream << text << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        FormatPercentilesLine(_swapLatency, _fenceLatency, text, sizeof(text));
+    }
+    stream << text << std::endl;
+}
+
+void FrameTimings::WriteInputLatency(std::ostream& stream) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (0u != _swapLatency.Count())
+    {
+        stream << "Input to swap latency: ";
+        _swapLatency.Write(stream);
+    }
+
+    if (0u != _fenceLatency.Count())
+    {
+        stream << "Input to fence latency: ";
+        _fenceLatency.Write(stream);
+    }
+}
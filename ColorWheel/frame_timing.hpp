@@ -0,0 +1,250 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef FRAME_TIMING
+#define FRAME_TIMING
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include "gl_query.hpp"
+#include "latency_histogram.hpp"
+
+
+// The parts of a frame that are timed.
+enum class FrameStage
+    : std::size_t
+{
+    Frame,              // The whole frame, from one BeginFrame() to the next (CPU only).
+    MeshGeneration,     // Building vertex data on the CPU (CPU only).
+    Upload,             // Sending vertex data to buffer objects.
+    WheelDraw,          // Drawing (or compositing) the color wheel.
+    Gui,                // Building and drawing the GUI.
+
+    Count
+};
+
+const char* ToString(const FrameStage stage) noexcept;
+
+// Rolling statistics of a stage, in milliseconds.
+struct TimingStatistics
+{
+    double      minimum;
+    double      average;
+    double      p99;
+    std::size_t samples;    // 0, if nothing has been measured yet.
+};
+
+// A fixed size window of the most recent samples of one stage.
+class TimingHistory
+{
+public:
+    static const std::size_t Capacity = 128u;
+
+    TimingHistory() noexcept
+        : _count(0u)
+        , _next(0u)
+    {
+    }
+
+    void Add(const double milliseconds) noexcept
+    {
+        _samples[_next] = milliseconds;
+        _next = (_next + 1u) % Capacity;
+        if (_count < Capacity)
+        {
+            ++_count;
+        }
+    }
+
+    TimingStatistics Statistics() const noexcept;
+
+private:
+    std::array<double, Capacity> _samples;
+    std::size_t _count;
+    std::size_t _next;
+};
+
+// Per-frame CPU and GPU instrumentation
+////////////////////////////////////////
+// CPU time is measured with a steady high resolution clock; time spent in several scopes of the same
+// stage within one frame is summed. GPU time is measured with GL_TIME_ELAPSED queries kept in a ring
+// per stage, so results are read a few frames late but never stall the pipeline.
+//
+// Input latency is measured from each input event's SDL timestamp until SDL_GL_SwapWindow() returns
+// for the first frame that reflects it; and, optionally, until a fence placed after the swap is
+// signaled. It's kept in log-linear histograms for the whole session, rather than a recent window.
+//
+// The game loop's thread calls BeginFrame(); the thread that owns the OpenGL context times GPU
+// scopes and calls CollectGpuTimes(). CPU time can be added from either; it counts toward whichever
+// frame is current when it's added.
+// NOTE: Requires an OpenGL context for the lifetime of the object. GPU scopes can't nest and each
+// stage can have only one GPU scope per frame.
+class FrameTimings
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    // Throws:  std::runtime_error : query objects couldn't be created.
+    FrameTimings();
+    virtual ~FrameTimings();
+
+    // Closes the previous frame's measurements and starts a new frame.
+    void BeginFrame() noexcept;
+
+    // Polls for finished GPU scopes without blocking. Call once per frame drawn.
+    void CollectGpuTimes() noexcept;
+
+    // Excludes time spent blocked waiting for input from the current frame, so the first frame drawn
+    // after an idle period doesn't measure (or animate) across it.
+    void ExcludeIdleTime(const clock::duration idle) noexcept
+    {
+        _frameStart += idle;
+    }
+
+    // Returns: the CPU time of the previous frame, in milliseconds (0 on the first frame).
+    double LastFrameMilliseconds() const noexcept
+    {
+        return _lastFrameMilliseconds;
+    }
+
+    void AddCpuTime(const FrameStage stage, const clock::duration elapsed) noexcept
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cpuThisFrame[static_cast<std::size_t>(stage)] += elapsed;
+    }
+
+    // Records the time from an input event until the frame it affected was swapped.
+    void AddInputLatency(const clock::duration latency) noexcept;
+
+    // Records the time from an input event until the GPU finished the frame it affected.
+    void AddFencedInputLatency(const clock::duration latency) noexcept;
+
+    // Throws:  InvalidOperation : another GPU scope is active.
+    void BeginGpu(const FrameStage stage);
+    // Throws:  InvalidOperation : BeginGpu() wasn't called for stage first.
+    void EndGpu(const FrameStage stage);
+
+    TimingStatistics CpuStatistics(const FrameStage stage) const noexcept
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _cpuHistory[static_cast<std::size_t>(stage)].Statistics();
+    }
+
+    TimingStatistics GpuStatistics(const FrameStage stage) const noexcept
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _gpuHistory[static_cast<std::size_t>(stage)].Statistics();
+    }
+
+    // Returns: statistics of the whole session's input to swap latency.
+    TimingStatistics InputLatencyStatistics() const noexcept;
+
+    // Returns: statistics of the whole session's input to fence latency.
+    TimingStatistics FencedInputLatencyStatistics() const noexcept;
+
+    bool IsOverlayVisible() const noexcept
+    {
+        return _isOverlayVisible;
+    }
+
+    void ToggleOverlay() noexcept
+    {
+        _isOverlayVisible = !_isOverlayVisible;
+    }
+
+    // Queues one imguiDrawText line per stage (min/avg/p99 of the CPU and GPU times), then the input
+    // latency rows, starting at (x, y) and going down the screen. Does nothing while the overlay is
+    // hidden.
+    void DrawOverlay(const int x, const int y) const;
+
+    // Writes the overlay's table to stream as plain text.
+    void WriteStatistics(std::ostream& stream) const;
+
+    // Writes the input latency histograms to stream; nothing, if no input has been drawn.
+    void WriteInputLatency(std::ostream& stream) const;
+
+    // Not copyable.
+    FrameTimings(const FrameTimings&) = delete;
+    FrameTimings& operator =(const FrameTimings&) = delete;
+
+private:
+    static const std::size_t StageCount = static_cast<std::size_t>(FrameStage::Count);
+
+    // Guards the CPU times and every history; they're shared between threads.
+    mutable std::mutex _mutex;
+    std::array<clock::duration, StageCount> _cpuThisFrame;
+    std::array<TimingHistory, StageCount> _cpuHistory;
+    std::array<TimingHistory, StageCount> _gpuHistory;
+    LatencyHistogram _swapLatency;
+    LatencyHistogram _fenceLatency;
+    std::array<gl::TimerQueryRing<>, StageCount> _gpuQueries;
+    clock::time_point _frameStart;
+    double _lastFrameMilliseconds;
+    bool _hasFrameStarted;
+    bool _isOverlayVisible;
+};
+
+// Adds the CPU time spent in a scope to a stage.
+class ScopedCpuTimer
+{
+public:
+    ScopedCpuTimer(FrameTimings& timings, const FrameStage stage) noexcept
+        : _timings(timings)
+        , _stage(stage)
+        , _start(FrameTimings::clock::now())
+    {
+    }
+
+    ~ScopedCpuTimer()
+    {
+        _timings.AddCpuTime(_stage, FrameTimings::clock::now() - _start);
+    }
+
+    // Not copyable.
+    ScopedCpuTimer(const ScopedCpuTimer&) = delete;
+    ScopedCpuTimer& operator =(const ScopedCpuTimer&) = delete;
+
+private:
+    FrameTimings& _timings;
+    const FrameStage _stage;
+    const FrameTimings::clock::time_point _start;
+};
+
+// Times the GPU execution of the commands issued in a scope as a stage.
+class ScopedGpuTimer
+{
+public:
+    // Throws:  InvalidOperation : another GPU scope is active.
+    ScopedGpuTimer(FrameTimings& timings, const FrameStage stage)
+        : _timings(timings)
+        , _stage(stage)
+    {
+        _timings.BeginGpu(_stage);
+    }
+
+    ~ScopedGpuTimer()
+    {
+        try
+        {
+            _timings.EndGpu(_stage);
+        }
+        catch (...)
+        {
+            // Only a sample is lost.
+        }
+    }
+
+    // Not copyable.
+    ScopedGpuTimer(const ScopedGpuTimer&) = delete;
+    ScopedGpuTimer& operator =(const ScopedGpuTimer&) = delete;
+
+private:
+    FrameTimings& _timings;
+    const FrameStage _stage;
+};
+
+
+#endif
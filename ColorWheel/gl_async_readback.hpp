@@ -0,0 +1,342 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_ASYNC_READBACK_HPP
+#define GL_ASYNC_READBACK_HPP
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <opengl/gl3.h>
+#include "gl_exceptions.hpp"
+#include "gl_buffer_object.hpp"
+
+
+namespace gl { namespace impl
+{
+
+    // Returns: the number of bytes in one pixel of the given glReadPixels format and type; or, 0 if
+    //              the combination isn't supported.
+    inline std::size_t BytesPerPixel(const GLenum format, const GLenum type) noexcept
+    {
+        std::size_t components = 0u;
+        switch (format)
+        {
+            case GL_RED:
+            case GL_GREEN:
+            case GL_BLUE:
+            case GL_DEPTH_COMPONENT:
+            case GL_STENCIL_INDEX:
+                components = 1u;
+                break;
+            case GL_RG:
+                components = 2u;
+                break;
+            case GL_RGB:
+            case GL_BGR:
+                components = 3u;
+                break;
+            case GL_RGBA:
+            case GL_BGRA:
+                components = 4u;
+                break;
+            default:
+                return 0u;
+        }
+
+        switch (type)
+        {
+            case GL_UNSIGNED_BYTE:
+            case GL_BYTE:
+                return components;
+            case GL_UNSIGNED_SHORT:
+            case GL_SHORT:
+            case GL_HALF_FLOAT:
+                return components * 2u;
+            case GL_UNSIGNED_INT:
+            case GL_INT:
+            case GL_FLOAT:
+                return components * 4u;
+            default:
+                break;
+        }
+        return 0u;
+    }
+
+    // Returns: the current GL_PACK_ALIGNMENT row alignment.
+    inline std::size_t PackAlignment() noexcept
+    {
+        GLint result = 4;
+        ::glGetIntegerv(GL_PACK_ALIGNMENT, &result);
+        return static_cast<std::size_t>(result);
+    }
+
+} // namespace impl
+
+    // OpenGL Sync Object wrapper
+    /////////////////////////////
+    // A fence inserted into the GL command stream; it signals once the GPU has executed every
+    // command issued before it.
+    class SyncObject
+    {
+    public:
+        SyncObject()
+            : _sync(::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+            , _isFlushed(false)
+        {
+            if (nullptr == _sync)
+            {
+                VerifyNoErrors();
+                throw std::runtime_error("failed to create an OpenGL fence sync object");
+            }
+        }
+
+        SyncObject(SyncObject&& original) noexcept
+            : _sync(nullptr)
+            , _isFlushed(false)
+        {
+            std::swap(original._sync, _sync);
+            std::swap(original._isFlushed, _isFlushed);
+        }
+
+        virtual ~SyncObject()
+        {
+            ::glDeleteSync(_sync);
+        }
+
+        SyncObject& operator =(SyncObject&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            ::glDeleteSync(_sync);
+            _sync = nullptr;
+            _isFlushed = false;
+
+            std::swap(rhs._sync, _sync);
+            std::swap(rhs._isFlushed, _isFlushed);
+
+            return *this;
+        }
+
+        GLsync Name() const noexcept
+        {
+            return _sync;
+        }
+
+        // Polls the fence without blocking.
+        // NOTE: The first poll also flushes the command stream so the fence is guaranteed to
+        // eventually signal.
+        // Returns: true, if every command issued before the fence has completed.
+        // Throws:  InvalidValue : the sync object was deleted behind this wrapper's back.
+        bool IsSignaled()
+        {
+            return Wait(0u);
+        }
+
+        // Blocks until the fence signals or timeoutNanoseconds elapse.
+        // Returns: true, if every command issued before the fence has completed.
+        // Throws:  InvalidValue : the sync object was deleted behind this wrapper's back.
+        bool Wait(const GLuint64 timeoutNanoseconds)
+        {
+            const GLbitfield flags = _isFlushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT;
+            _isFlushed = true;
+
+            switch (::glClientWaitSync(_sync, flags, timeoutNanoseconds))
+            {
+                case GL_ALREADY_SIGNALED:
+                case GL_CONDITION_SATISFIED:
+                    return true;
+                case GL_TIMEOUT_EXPIRED:
+                    return false;
+                default:
+                    break;
+            }
+
+            VerifyNoErrors();
+            throw std::runtime_error("failed waiting on an OpenGL fence sync object");
+        }
+
+        // Not copyable.
+        SyncObject(const SyncObject&) = delete;
+        SyncObject& operator =(const SyncObject&) = delete;
+
+    private:
+        GLsync _sync;
+        bool _isFlushed;
+    };
+
+    // Asynchronous GPU-to-CPU readback
+    ///////////////////////////////////
+    // Pairs a PixelPack buffer object with a fence. A read (pixels from the current read framebuffer,
+    // or a range of another buffer object) is queued into the PixelPack buffer and returns
+    // immediately; the caller polls IsReady() on later frames and maps the result once the GPU has
+    // caught up, so the render loop never stalls on the transfer.
+    class AsyncReadback
+    {
+    public:
+        typedef BufferObject<BufferObjectType::PixelPack> pixel_pack_buffer;
+
+        template<typename T>
+        using mapped_ptr = std::unique_ptr<const T, pixel_pack_buffer::UnmapDeleter<const T>>;
+
+        AsyncReadback()
+            : _sizeInBytes(0u)
+        {
+        }
+
+        AsyncReadback(AsyncReadback&& original) noexcept
+            : _buffer(std::move(original._buffer))
+            , _pFence(std::move(original._pFence))
+            , _sizeInBytes(original._sizeInBytes)
+        {
+            original._sizeInBytes = 0u;
+        }
+
+        virtual ~AsyncReadback()
+        {
+        }
+
+        AsyncReadback& operator =(AsyncReadback&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            _buffer = std::move(rhs._buffer);
+            _pFence = std::move(rhs._pFence);
+            _sizeInBytes = rhs._sizeInBytes;
+            rhs._sizeInBytes = 0u;
+
+            return *this;
+        }
+
+        // Queues a read of a rectangle of the current read framebuffer. Rows are padded to
+        // GL_PACK_ALIGNMENT, exactly as glReadPixels lays them out.
+        // Throws:  InvalidValue : width or height is negative; -or-, format and type aren't one of
+        //              the combinations BytesPerPixel() knows how to size.
+        //          InvalidOperation : format and type don't match the read framebuffer.
+        //          InvalidFramebufferOperation : the read framebuffer is incomplete.
+        //          OutOfMemory
+        void ReadPixels(
+            const GLint x,
+            const GLint y,
+            const GLsizei width,
+            const GLsizei height,
+            const GLenum format,
+            const GLenum type
+            )
+        {
+            const auto bytesPerPixel = impl::BytesPerPixel(format, type);
+            if (0u == bytesPerPixel || width < 0 || height < 0)
+            {
+                throw InvalidValue();
+            }
+
+            const auto alignment = impl::PackAlignment();
+            const auto rowBytes = (width * bytesPerPixel + alignment - 1u) / alignment * alignment;
+
+            Allocate(rowBytes * height);
+
+            _buffer.Bind();
+            ::glReadPixels(x, y, width, height, format, type, nullptr);
+            pixel_pack_buffer::Unbind();
+            VerifyNoErrors();
+
+            _pFence.reset(new SyncObject);
+        }
+
+        // Queues a copy of count elements of type T out of source, e.g.: to export generated
+        // geometry without waiting on the GPU.
+        // Throws:  InvalidValue : the range is beyond source's allocated data store.
+        //          InvalidOperation : source is mapped.
+        //          OutOfMemory
+        template<typename T, BufferObjectType source_t>
+        void CopyFrom(
+            const BufferObject<source_t>& source,
+            const std::size_t elementOffset,
+            const std::size_t count
+            )
+        {
+            Allocate(count * sizeof(T));
+            _buffer.CopySubData<T>(source, elementOffset, 0u, count);
+            _pFence.reset(new SyncObject);
+        }
+
+        // Returns: true, if a read has been queued and not yet discarded.
+        bool IsPending() const noexcept
+        {
+            return nullptr != _pFence;
+        }
+
+        // Polls without blocking.
+        // Returns: true, if the queued read has landed and Map() won't stall.
+        bool IsReady()
+        {
+            return IsPending() && _pFence->IsSignaled();
+        }
+
+        // The number of bytes the queued read produces.
+        std::size_t SizeInBytes() const noexcept
+        {
+            return _sizeInBytes;
+        }
+
+        // Maps the landed data for reading.
+        // NOTE: The PixelPack target stays bound to this buffer object until the returned pointer
+        // is destroyed; don't issue other pixel pack operations in between.
+        // Throws:  std::logic_error : the read hasn't landed yet (see: IsReady()).
+        //          OutOfMemory : OpenGL is unable to map the buffer object's data store.
+        template<typename T>
+        mapped_ptr<T> Map()
+        {
+            if (!IsReady())
+            {
+                throw std::logic_error("asynchronous readback hasn't completed");
+            }
+
+            _buffer.Bind();
+            mapped_ptr<T> pMappedBuffer(static_cast<const T*>(::glMapBuffer(
+                static_cast<GLenum>(BufferObjectType::PixelPack),
+                GL_READ_ONLY
+                )));
+            VerifyNoErrors();
+            return pMappedBuffer;
+        }
+
+        // Forgets the queued read; the buffer object's storage is kept for the next one.
+        void Discard() noexcept
+        {
+            _pFence.reset();
+        }
+
+        // Not copyable.
+        AsyncReadback(const AsyncReadback&) = delete;
+        AsyncReadback& operator =(const AsyncReadback&) = delete;
+
+    private:
+        // (Re)allocates the data store; orphaning it lets the driver hand back fresh storage
+        // rather than waiting on a transfer that may still be in flight.
+        void Allocate(const std::size_t sizeInBytes)
+        {
+            _pFence.reset();
+            _sizeInBytes = sizeInBytes;
+
+            _buffer.Bind();
+            _buffer.Data<GLubyte>(UsagePattern::StreamRead, nullptr, sizeInBytes);
+            pixel_pack_buffer::Unbind();
+        }
+
+        pixel_pack_buffer _buffer;
+        std::unique_ptr<SyncObject> _pFence;
+        std::size_t _sizeInBytes;
+    };
+
+} // namespace gl
+
+
+#endif
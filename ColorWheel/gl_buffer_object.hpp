@@ -7,6 +7,8 @@
 #include <utility>
 #include <opengl/gl3.h>
 #include "gl_exceptions.hpp"
+#include "gl_state_cache.hpp"
+#include "gl_scratch.inl"
 
 
 namespace gl { namespace impl
@@ -29,6 +31,7 @@ namespace gl { namespace impl
     inline void DeleteBufferObjectName(const GLuint bufferObjectName) noexcept
     {
         ::glDeleteBuffers(1, &bufferObjectName);
+        StateCache::Instance().BufferDeleted(bufferObjectName);
     }
 
     template<GLsizei count>
@@ -36,6 +39,10 @@ namespace gl { namespace impl
     {
         assert(count >= 1);
         ::glDeleteBuffers(count, bufferObjectNames);
+        for (const auto bufferObjectName : bufferObjectNames)
+        {
+            StateCache::Instance().BufferDeleted(bufferObjectName);
+        }
     }
 
 } // namespace impl
@@ -280,14 +287,15 @@ namespace gl { namespace impl
             return buffer_object_t;
         }
 
+        // NOTE: Skipped if this buffer object is already bound to its target.
         void Bind() const noexcept
         {
-            ::glBindBuffer(static_cast<GLenum>(buffer_object_t), _name);
+            StateCache::Instance().BindBuffer(static_cast<GLenum>(buffer_object_t), _name);
         }
 
         static void Unbind() noexcept
         {
-            ::glBindBuffer(static_cast<GLenum>(buffer_object_t), 0);
+            StateCache::Instance().BindBuffer(static_cast<GLenum>(buffer_object_t), 0);
         }
 
         // Throws:  InvalidOperation : Bind() wasn't called before this method.
@@ -377,14 +385,14 @@ namespace gl { namespace impl
             const GLsizeiptr size = std::min<std::size_t>(
                 v.size() * sizeof(GLint), std::numeric_limits<GLsizeiptr>::max());
 
-            std::vector<GLint> data(size);
-            std::transform(v.cbegin(), v.cend(), data.begin(),
+            impl::detail::GLintScratch data(v.size());
+            std::transform(v.cbegin(), v.cend(), data.data(),
                            [](const bool b) { return b ? GL_TRUE : GL_FALSE; });
 
             ::glBufferData(
                 static_cast<GLenum>(buffer_object_t),
                 size,
-                &data[0],
+                data.data(),
                 static_cast<GLenum>(usagePattern)
                 );
 
@@ -521,15 +529,15 @@ namespace gl { namespace impl
                 elementOffset * sizeof(GLint), std::numeric_limits<GLintptr>::max());
             const GLsizeiptr size = v.size() * sizeof(GLint);
 
-            std::vector<GLint> data(size);
-            std::transform(v.cbegin(), v.cend(), data.begin(),
+            impl::detail::GLintScratch data(v.size());
+            std::transform(v.cbegin(), v.cend(), data.data(),
                            [](const bool b) { return b ? GL_TRUE : GL_FALSE; });
 
             ::glBufferSubData(
                 static_cast<GLenum>(buffer_object_t),
                 offset,
                 size,
-                &data[0]
+                data.data()
                 );
 
             // NOTE: An InvalidEnum here indicates a programming error.
@@ -670,21 +678,58 @@ namespace gl { namespace impl
                 elementOffset * sizeof(GLint), std::numeric_limits<GLintptr>::max());
             const GLsizeiptr size = v.size() * sizeof(GLint);
 
-            std::vector<GLint> data(size);
+            impl::detail::GLintScratch data(v.size());
 
             ::glGetBufferSubData(
                 static_cast<GLenum>(buffer_object_t),
                 offset,
                 size,
-                &data[0]
+                data.data()
                 );
 
             VerifyNoErrors();
 
-            std::transform(data.cbegin(), data.cend(), v.begin(),
+            std::transform(data.data(), data.data() + v.size(), v.begin(),
                            [](const GLint i) { return GL_FALSE != i; });
         }
 
+        // Copies count elements of type T from source's data store into this buffer object's data
+        // store on the GPU, without a round trip through system memory. The source is bound to
+        // GL_COPY_READ_BUFFER and this buffer object to GL_COPY_WRITE_BUFFER; neither of the
+        // buffer objects' own targets is disturbed.
+        // Throws:  InvalidValue : either range is beyond its buffer object's allocated data store;
+        //              -or-, source is this buffer object and the ranges overlap.
+        //          InvalidOperation : either buffer object is mapped.
+        template<typename T, BufferObjectType source_t>
+        void CopySubData(
+            const BufferObject<source_t>& source,
+            const std::size_t sourceElementOffset,
+            const std::size_t elementOffset,
+            const std::size_t count
+            )
+        {
+            // check for overflow
+            assert(sourceElementOffset <= std::numeric_limits<GLintptr>::max() / sizeof(T));
+            assert(elementOffset <= std::numeric_limits<GLintptr>::max() / sizeof(T));
+            assert(count <= std::numeric_limits<GLsizeiptr>::max() / sizeof(T));
+
+            // clip in release mode
+            const GLintptr readOffset = std::min<std::size_t>(
+                sourceElementOffset * sizeof(T), std::numeric_limits<GLintptr>::max());
+            const GLintptr writeOffset = std::min<std::size_t>(
+                elementOffset * sizeof(T), std::numeric_limits<GLintptr>::max());
+            const GLsizeiptr size = std::min<std::size_t>(
+                count * sizeof(T), std::numeric_limits<GLsizeiptr>::max());
+
+            auto& stateCache = StateCache::Instance();
+            stateCache.BindBuffer(GL_COPY_READ_BUFFER, source.Name());
+            stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, _name);
+
+            ::glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, size);
+
+            VerifyNoErrors();
+        }
+
         // Throws:  InvalidEnum : buffer type is not GL_TRANSFORM_FEEDBACK_BUFFER or
         //              GL_UNIFORM_BUFFER.
         //          InvalidValue : index is greater than or equal to the number of target-specific
@@ -24,6 +24,9 @@ namespace gl
     public:
         InvalidFramebufferOperation() noexcept
             : std::logic_error("framebuffer is incomplete") {}
+
+        explicit InvalidFramebufferOperation(const char* const reason) noexcept
+            : std::logic_error(reason) {}
     };
 
     class InvalidValue
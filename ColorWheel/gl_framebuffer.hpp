@@ -0,0 +1,253 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_FRAMEBUFFER_HPP
+#define GL_FRAMEBUFFER_HPP
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <opengl/gl3.h>
+#include "gl_exceptions.hpp"
+#include "gl_state_cache.hpp"
+#include "gl_texture.hpp"
+
+
+namespace gl { namespace impl
+{
+
+    inline GLuint GenerateFramebufferName() noexcept
+    {
+        GLuint result = 0;
+        ::glGenFramebuffers(1, &result);
+        return result;
+    }
+
+    inline void DeleteFramebufferName(const GLuint framebufferName) noexcept
+    {
+        ::glDeleteFramebuffers(1, &framebufferName);
+        StateCache::Instance().FramebufferDeleted(framebufferName);
+    }
+
+    // Returns: a description of a glCheckFramebufferStatus result.
+    inline const char* FramebufferStatusToString(const GLenum status) noexcept
+    {
+        switch (status)
+        {
+            case GL_FRAMEBUFFER_COMPLETE:
+                return "framebuffer is complete";
+            case GL_FRAMEBUFFER_UNDEFINED:
+                return "framebuffer is incomplete: the default framebuffer doesn't exist";
+            case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+                return "framebuffer is incomplete: an attachment is incomplete";
+            case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+                return "framebuffer is incomplete: no images are attached";
+            case GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER:
+                return "framebuffer is incomplete: a draw buffer has no attachment";
+            case GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER:
+                return "framebuffer is incomplete: the read buffer has no attachment";
+            case GL_FRAMEBUFFER_UNSUPPORTED:
+                return "framebuffer is incomplete: the combination of attachment formats is unsupported";
+            case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:
+                return "framebuffer is incomplete: attachments have mismatched sample counts";
+            case GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS:
+                return "framebuffer is incomplete: attachments have mismatched layer targets";
+            default:
+                break;
+        }
+        return "framebuffer is incomplete";
+    }
+
+} // namespace impl
+
+    enum class FramebufferTarget
+        : GLenum
+    {
+        Draw        = GL_DRAW_FRAMEBUFFER,
+        Read        = GL_READ_FRAMEBUFFER,
+        DrawRead    = GL_FRAMEBUFFER,
+    };
+
+    // OpenGL Framebuffer Object Name wrapper
+    /////////////////////////////////////////
+    class FramebufferName
+    {
+    public:
+        typedef GLuint          value_type;
+        typedef value_type&     reference;
+
+        FramebufferName()
+            : _handle(impl::GenerateFramebufferName())
+        {
+            if (0u == _handle)
+            {
+                throw std::runtime_error("failed to generate an OpenGL framebuffer object name");
+            }
+        }
+
+        FramebufferName(FramebufferName&& original) noexcept
+            : _handle(0u)
+        {
+            std::swap(original._handle, _handle);
+        }
+
+        virtual ~FramebufferName()
+        {
+            impl::DeleteFramebufferName(_handle);
+        }
+
+        FramebufferName& operator =(FramebufferName&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            impl::DeleteFramebufferName(_handle);
+            _handle = 0u;
+
+            std::swap(rhs._handle, _handle);
+
+            return *this;
+        }
+
+        operator value_type() const noexcept
+        {
+            return _handle;
+        }
+
+        // Not copyable.
+        FramebufferName(const FramebufferName&) = delete;
+        FramebufferName& operator =(const FramebufferName&) = delete;
+
+    private:
+        value_type _handle;
+    };
+
+    // OpenGL Framebuffer Object wrapper
+    ////////////////////////////////////
+    // NOTE: The framebuffer doesn't own its attachments; attached textures must outlive their use
+    // through it.
+    class Framebuffer
+    {
+    public:
+        Framebuffer()
+        {
+        }
+
+        Framebuffer(Framebuffer&& original) noexcept
+            : _name(std::move(original._name))
+        {
+        }
+
+        virtual ~Framebuffer()
+        {
+        }
+
+        Framebuffer& operator =(Framebuffer&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            _name = std::move(rhs._name);
+
+            return *this;
+        }
+
+        GLuint Name() const noexcept
+        {
+            return _name;
+        }
+
+        void Bind(const FramebufferTarget target = FramebufferTarget::DrawRead) const noexcept
+        {
+            StateCache::Instance().BindFramebuffer(static_cast<GLenum>(target), _name);
+        }
+
+        // Binds the default (window system provided) framebuffer.
+        static void Unbind(const FramebufferTarget target = FramebufferTarget::DrawRead) noexcept
+        {
+            StateCache::Instance().BindFramebuffer(static_cast<GLenum>(target), 0);
+        }
+
+        // Attaches one mip level of texture as color attachment index.
+        // NOTE: Binds this framebuffer to both the draw and read targets.
+        // Throws:  InvalidValue : index >= GL_MAX_COLOR_ATTACHMENTS; -or-, level isn't one of the
+        //              texture's allocated levels.
+        //          InvalidOperation : the texture's storage hasn't been allocated.
+        void AttachColor(const Texture& texture, const GLuint index = 0u, const GLint level = 0)
+        {
+            Attach(GL_COLOR_ATTACHMENT0 + index, texture, level);
+        }
+
+        // Throws:  InvalidValue : level isn't one of the texture's allocated levels.
+        //          InvalidOperation : the texture's storage hasn't been allocated.
+        void AttachDepth(const Texture& texture, const GLint level = 0)
+        {
+            Attach(GL_DEPTH_ATTACHMENT, texture, level);
+        }
+
+        // Throws:  InvalidValue : level isn't one of the texture's allocated levels.
+        //          InvalidOperation : the texture's storage hasn't been allocated.
+        void AttachDepthStencil(const Texture& texture, const GLint level = 0)
+        {
+            Attach(GL_DEPTH_STENCIL_ATTACHMENT, texture, level);
+        }
+
+        // Returns: the glCheckFramebufferStatus result for this framebuffer.
+        // NOTE: Binds this framebuffer to both the draw and read targets.
+        GLenum Status() const
+        {
+            Bind();
+            const auto status = ::glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            VerifyNoErrors();
+            return status;
+        }
+
+        bool IsComplete() const
+        {
+            return GL_FRAMEBUFFER_COMPLETE == Status();
+        }
+
+        // Throws:  InvalidFramebufferOperation : the framebuffer is incomplete; what() describes
+        //              the reason reported by the driver.
+        void Validate() const
+        {
+            const auto status = Status();
+            if (GL_FRAMEBUFFER_COMPLETE != status)
+            {
+                throw InvalidFramebufferOperation(impl::FramebufferStatusToString(status));
+            }
+        }
+
+        // Not copyable.
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator =(const Framebuffer&) = delete;
+
+    private:
+        void Attach(const GLenum attachment, const Texture& texture, const GLint level)
+        {
+            if (!texture.IsAllocated())
+            {
+                throw InvalidOperation();
+            }
+
+            if (level < 0 || level >= texture.Levels())
+            {
+                throw InvalidValue();
+            }
+
+            Bind();
+            ::glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.Name(), level);
+            VerifyNoErrors();
+        }
+
+        FramebufferName _name;
+    };
+
+} // namespace gl
+
+
+#endif
@@ -8,6 +8,7 @@
 #include <opengl/gl3.h>
 #include <glm/glm.hpp>
 #include "gl_exceptions.hpp"
+#include "gl_state_cache.hpp"
 #include "gl_info_log.inl"
 #include "gl_get_uniform.hpp"
 #include "gl_set_uniform.hpp"
@@ -178,6 +179,84 @@ namespace gl { namespace impl
         return std::string(&nameBuffer[0], std::min(static_cast<size_t>(length), nameBuffer.size()));
     }
 
+    // Returns: The location of a vertex shader input variable, or -1 if not found.
+    // Throws:  InvalidOperation : programName is bad;
+    //                             or, the program hasn't been linked yet
+    inline GLint GetAttributeLocation(const GLuint programName, const std::string& attributeName)
+    {
+        const auto result = ::glGetAttribLocation(programName, attributeName.c_str());
+        VerifyNoErrors();
+        return result;
+    }
+
+    // Returns: The number of active vertex shader input variables of the specified shader program.
+    // Throws:  InvalidValue : programName is bad
+    //          InvalidOperation : programName is bad
+    inline GLint GetActiveAttributeCount(const GLuint programName)
+    {
+        GLint result = 0;
+        ::glGetProgramiv(programName, GL_ACTIVE_ATTRIBUTES, &result);
+        VerifyNoErrors(); // Any other exception types indicate a programming error.
+        return result;
+    }
+
+    // Returns: The maximum buffer size required to read any active attribute name (including
+    //              null-terminator; or, 0 if there are no active attributes.
+    // Throws:  InvalidValue : programName is bad
+    //          InvalidOperation : programName is bad
+    inline GLint GetAttributeMaxLength(const GLuint programName)
+    {
+        GLint result = 0;
+        ::glGetProgramiv(programName, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &result);
+        VerifyNoErrors(); // Any other exception types indicate a programming error.
+        return result;
+    }
+
+    // Arguments: attributeIndex : legal values are from 0 to GetActiveAttributeCount() - 1
+    // Returns: The name of the active attribute at the specified index; or, an empty string.
+    //          size : Returns the array size of the attribute (1 for non-arrays).
+    //          type : The GL type of the attribute: GL_FLOAT, GL_FLOAT_VEC2, GL_INT_VEC4, etc...
+    // Throws:  InvalidValue : programName is bad;
+    //                         or, attributeIndex is greater than or equal to the number of active
+    //                             attributes in program.
+    //          InvalidOperation : programName is bad
+    //          std::bad_alloc
+    inline std::string GetActiveAttribute(
+                                          const GLuint    programName,
+                                          const GLuint    attributeIndex,
+                                          GLint&          size,
+                                          GLenum&         type
+                                          )
+    {
+        std::vector<GLchar> nameBuffer;
+        {
+            const auto RequiredBufferSize = GetAttributeMaxLength(programName);
+
+            if (0 == RequiredBufferSize)
+            {
+                return "";
+            }
+
+            nameBuffer.resize(RequiredBufferSize);
+        }
+
+        GLsizei length = 0;
+        {
+            ::glGetActiveAttrib(
+                                programName,
+                                attributeIndex,
+                                static_cast<GLsizei>(nameBuffer.size()),
+                                &length,
+                                &size,
+                                &type,
+                                &nameBuffer[0]
+                                );
+            VerifyNoErrors();
+        }
+
+        return std::string(&nameBuffer[0], std::min(static_cast<size_t>(length), nameBuffer.size()));
+    }
+
     inline std::string CopyProgramInfoLog(const GLuint programName)
     {
         return detail::CopyGlInfoLog(programName, &::glGetProgramiv, &::glGetProgramInfoLog);
@@ -207,6 +286,7 @@ namespace gl { namespace impl
         {
             ::glDeleteProgram(_programName);
             AssertNoErrors();
+            StateCache::Instance().ProgramDeleted(_programName);
         }
 
         // Get the native OpenGL name of this program resource.
@@ -278,11 +358,27 @@ namespace gl { namespace impl
         }
 
         // Add this program to the currently active set of running shader programs.
+        // NOTE: Skipped if this program is already in use.
         // Throws: InvalidOperation : the program could not be made part of current state;
         //                            or, transform feedback mode is active
         void Use()
         {
-            impl::Use(_programName);
+            auto& stateCache = StateCache::Instance();
+            if (!stateCache.UseProgram(_programName))
+            {
+                return;
+            }
+
+            try
+            {
+                VerifyNoErrors();
+            }
+            catch (...)
+            {
+                // The previous program is still in use; don't trust the cache.
+                stateCache.Invalidate();
+                throw;
+            }
         }
 
         // Causes the OpenGL driver to validate the current shader program.
@@ -328,6 +424,34 @@ namespace gl { namespace impl
             return impl::GetUniformLocation(_programName, uniformName);
         }
 
+        // Returns: The number of active vertex shader input variables of this shader program.
+        GLint GetActiveAttributeCount() const noexcept
+        {
+            return impl::GetActiveAttributeCount(_programName);
+        }
+
+        // Used to get the name, size, and type of a vertex shader input via its OpenGL assigned
+        // index.
+        // Arguments: attributeIndex : legal values are from 0 to GetActiveAttributeCount() - 1
+        // Returns: The name of the active attribute at the specified index; or, an empty string.
+        //          size : Returns the array size of the attribute (1 for non-arrays).
+        //          type : Returns the GL type of the attribute: GL_FLOAT, GL_FLOAT_VEC2, etc...
+        // Throws:  InvalidValue : attributeIndex is greater than or equal to the number of active
+        //                             attributes in program.
+        //          std::bad_alloc
+        std::string GetActiveAttribute(const GLuint attributeIndex, GLint& size, GLenum& type) const
+        {
+            return impl::GetActiveAttribute(_programName, attributeIndex, size, type);
+        }
+
+        // Used to find the vector index bound to a vertex shader input variable via its name.
+        // Returns: The location of the attribute, or -1 if not found.
+        // Throws: InvalidOperation : the program hasn't been linked yet
+        GLint GetAttributeLocation(const std::string& attributeName) const
+        {
+            return impl::GetAttributeLocation(_programName, attributeName);
+        }
+
         // Gets the current value of a uniform via its OpenGL assigned index.
         // Returns: the requested uniform variable
         // Throws: InvalidOperation : uniformLocation is bad;
@@ -0,0 +1,177 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_QUERY_HPP
+#define GL_QUERY_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <opengl/gl3.h>
+#include "gl_exceptions.hpp"
+
+
+namespace gl { namespace impl
+{
+
+    inline GLuint GenerateQueryName() noexcept
+    {
+        GLuint result = 0;
+        ::glGenQueries(1, &result);
+        return result;
+    }
+
+    inline void DeleteQueryName(const GLuint queryName) noexcept
+    {
+        ::glDeleteQueries(1, &queryName);
+    }
+
+} // namespace impl
+
+    // OpenGL Query Object Name wrapper
+    ///////////////////////////////////
+    class QueryName
+    {
+    public:
+        typedef GLuint          value_type;
+        typedef value_type&     reference;
+
+        QueryName()
+            : _handle(impl::GenerateQueryName())
+        {
+            if (0u == _handle)
+            {
+                throw std::runtime_error("failed to generate an OpenGL query object name");
+            }
+        }
+
+        QueryName(QueryName&& original) noexcept
+            : _handle(0u)
+        {
+            std::swap(original._handle, _handle);
+        }
+
+        virtual ~QueryName()
+        {
+            impl::DeleteQueryName(_handle);
+        }
+
+        QueryName& operator =(QueryName&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            impl::DeleteQueryName(_handle);
+            _handle = 0u;
+
+            std::swap(rhs._handle, _handle);
+
+            return *this;
+        }
+
+        operator value_type() const noexcept
+        {
+            return _handle;
+        }
+
+        // Not copyable.
+        QueryName(const QueryName&) = delete;
+        QueryName& operator =(const QueryName&) = delete;
+
+    private:
+        value_type _handle;
+    };
+
+    // GL_TIME_ELAPSED query ring
+    /////////////////////////////
+    // Measures the GPU time spent executing the commands issued between Begin() and End(). Results
+    // lag the commands by a few frames; keeping Latency queries in flight lets Collect() poll the
+    // oldest one without ever stalling the pipeline waiting on a result.
+    // NOTE: Time elapsed queries can't nest, or overlap, with any other time elapsed query.
+    template<std::size_t Latency = 4u>
+    class TimerQueryRing
+    {
+    public:
+        TimerQueryRing()
+            : _next(0u)
+            , _isActive(false)
+        {
+            _isPending.fill(false);
+        }
+
+        virtual ~TimerQueryRing()
+        {
+        }
+
+        // Starts timing into the next query of the ring. If that query's result was never
+        // collected, it's abandoned.
+        // Throws:  InvalidOperation : another time elapsed query is already active.
+        void Begin()
+        {
+            ::glBeginQuery(GL_TIME_ELAPSED, _queries[_next]);
+            VerifyNoErrors();
+            _isPending[_next] = false;
+            _isActive = true;
+        }
+
+        // Throws:  InvalidOperation : Begin() wasn't called first.
+        void End()
+        {
+            ::glEndQuery(GL_TIME_ELAPSED);
+            VerifyNoErrors();
+            _isPending[_next] = true;
+            _isActive = false;
+            _next = (_next + 1u) % Latency;
+        }
+
+        bool IsActive() const noexcept
+        {
+            return _isActive;
+        }
+
+        // Polls the oldest outstanding query without blocking.
+        // Returns: true, and the elapsed GPU time in nanoseconds, if a result was available.
+        bool Collect(GLuint64& nanoseconds) noexcept
+        {
+            for (std::size_t i = 0u; i < Latency; ++i)
+            {
+                // Oldest first: the slot Begin() will reuse next, then forward.
+                const auto slot = (_next + i) % Latency;
+                if (!_isPending[slot])
+                {
+                    continue;
+                }
+
+                GLuint isAvailable = GL_FALSE;
+                ::glGetQueryObjectuiv(_queries[slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+                if (GL_FALSE == isAvailable)
+                {
+                    // Later queries can't have finished before this one.
+                    return false;
+                }
+
+                ::glGetQueryObjectui64v(_queries[slot], GL_QUERY_RESULT, &nanoseconds);
+                _isPending[slot] = false;
+                return true;
+            }
+            return false;
+        }
+
+        // Not copyable.
+        TimerQueryRing(const TimerQueryRing&) = delete;
+        TimerQueryRing& operator =(const TimerQueryRing&) = delete;
+
+    private:
+        std::array<QueryName, Latency> _queries;
+        std::array<bool, Latency> _isPending;
+        std::size_t _next;
+        bool _isActive;
+    };
+
+} // namespace gl
+
+
+#endif
@@ -0,0 +1,60 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_SCRATCH_INL
+#define GL_SCRATCH_INL
+
+#include <cstddef>
+#include <vector>
+#include <opengl/gl3.h>
+
+
+namespace gl { namespace impl { namespace detail
+{
+
+    // Returns: a per-thread buffer with room for at least count GLints.
+    // The buffer only ever grows and lives until the thread exits, so once it has reached the
+    // high-water mark of a caller's uploads, no further heap allocations are made.
+    // Throws:  std::bad_alloc
+    inline GLint* ThreadScratchGLints(const std::size_t count)
+    {
+        static thread_local std::vector<GLint> scratch;
+        if (scratch.size() < count)
+        {
+            scratch.resize(count);
+        }
+        return scratch.data();
+    }
+
+    // Temporary storage used to convert bool data to the GLint data OpenGL expects.
+    // Small conversions live on the stack; larger ones borrow the per-thread scratch buffer.
+    // NOTE: Only one instance that spills to the scratch buffer may be live per thread.
+    class GLintScratch
+    {
+    public:
+        static const std::size_t StackCount = 64u;
+
+        // Throws:  std::bad_alloc
+        explicit GLintScratch(const std::size_t count)
+            : _data(count <= StackCount ? _stack : ThreadScratchGLints(count))
+        {
+        }
+
+        GLint* data() noexcept
+        {
+            return _data;
+        }
+
+        // Not copyable.
+        GLintScratch(const GLintScratch&) = delete;
+        GLintScratch& operator =(const GLintScratch&) = delete;
+
+    private:
+        GLint _stack[StackCount];
+        GLint* const _data;
+    };
+
+} } } // namespace gl::impl::detail
+
+
+#endif
@@ -5,6 +5,7 @@
 #define SET_UNIFORM_H
 
 #include <array>
+#include "gl_scratch.inl"
 
 
 namespace gl { namespace impl
@@ -130,10 +131,11 @@ namespace gl { namespace impl
             typedef GLboolean T;\
             static void Set(const GLint ul, const T v[], const GLsizei s)\
             {\
-                std::vector<GLint> buffer(s);\
-                std::transform(&v[0], &v[s], std::begin(buffer),\
+                const auto length = s * element_count;\
+                GLintScratch buffer(length);\
+                std::transform(&v[0], &v[length], buffer.data(),\
                        [](const T& e) { return b2i(e); });\
-                ::glUniform##element_count##iv(ul, s, &buffer[0]);\
+                ::glUniform##element_count##iv(ul, s, buffer.data());\
             }\
         }
 
@@ -158,7 +160,7 @@ namespace gl { namespace impl
             {\
                 static void Set(const GLint ul, const bool v[], const GLsizei s)\
                 {\
-                    ::glUniform1iv(ul, s, reinterpret_cast<const GLint*>(v));\
+                    ::glUniform##element_count##iv(ul, s, reinterpret_cast<const GLint*>(v));\
                 }\
             };\
 \
@@ -168,10 +170,10 @@ namespace gl { namespace impl
                 static void Set(const GLint ul, const bool v[], const GLsizei s)\
                 {\
                     const auto length = s * element_count;\
-                    std::vector<GLint> buffer(length);\
-                    std::transform(&v[0], &v[length], std::begin(buffer),\
+                    GLintScratch buffer(length);\
+                    std::transform(&v[0], &v[length], buffer.data(),\
                                    [](const bool& e) { return b2i(e); });\
-                    ::glUniform##element_count##iv(ul, s, &buffer[0]);\
+                    ::glUniform##element_count##iv(ul, s, buffer.data());\
                 }\
             }
 
@@ -188,7 +190,7 @@ namespace gl { namespace impl
 
             static void Set(const GLint ul, const T v[], const GLsizei s)
             {
-                b2ia::BoolToIntArray<sizeof(T) != sizeof(GLint), element_count>::Set(ul, v, s);
+                b2ia::BoolToIntArray<sizeof(T) == sizeof(GLint), element_count>::Set(ul, v, s);
             }
         };
 
@@ -451,10 +453,10 @@ namespace gl { namespace impl
                 const typename vector_type::size_type MaxCount = std::numeric_limits<GLsizei>::max();
                 assert(v.size() <= MaxCount);
                 const auto count = static_cast<GLsizei>(std::min(MaxCount, v.size()));
-                std::vector<GLint> buffer(count);
-                std::transform(v.cbegin(), v.cend(), std::begin(buffer),
+                GLintScratch buffer(count);
+                std::transform(v.cbegin(), v.cbegin() + count, buffer.data(),
                                [](const bool& e) { return b2i(e); });
-                SetArray<GLint, 1>::Set(ul, &buffer[0], count);
+                SetArray<GLint, 1>::Set(ul, buffer.data(), count);
             }
         };
 
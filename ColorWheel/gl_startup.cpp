@@ -1,10 +1,10 @@
 //  Copyright (c) 2016 Christopher Gassib. All rights reserved.
 //
 
+#include <cstddef>
+#include <cstdlib>
 #include <string>
 #include <iostream>
-#include <sstream>
-#include <array>
 #include <fstream>
 
 #include <SDL2/SDL.h>           // Primary SDL include for all platforms.
@@ -21,33 +21,74 @@
 #include "gl_startup.hpp"
 
 
-// Throws : SdlException
-//          std::bad_alloc
-std::string LoadTextFile(const std::string& filename)
+namespace
 {
-    const size_t BufferSize = 4096u;
 
-    std::string fullpath(sdl::GetExecutablePath().get() + filename);
+    // Shader sources, embedded by tools/shader_embed; the Xcode target's Embed Shaders phase
+    // regenerates them before compiling whenever a shader changes.
+    struct EmbeddedText
+    {
+        const char*     pName;
+        const char*     pText;
+        std::size_t     size;
+    };
+
+#include "embedded_shaders.inc"
+
+    // Returns: false, if the file can't be opened.
+    // Throws:  std::bad_alloc
+    bool ReadTextFile(const std::string& path, std::string& text)
+    {
+        std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+        if (!ifs)
+        {
+            return false;
+        }
 
-    std::cout << "Loading: " << fullpath << std::endl;
+        text.resize(static_cast<std::size_t>(ifs.tellg()));
+        ifs.seekg(0);
+        ifs.read(&text[0], text.size());
+        text.resize(static_cast<std::size_t>(ifs.gcount()));
+        return true;
+    }
+
+} // namespace
+
+
+// Set COLORWHEEL_SHADER_DIR to a directory of shader sources to use those while editing them,
+// without regenerating embedded_shaders.inc.
+// Throws : SdlException : the shader isn't embedded, and the executable's path is unknown.
+//          std::bad_alloc
+std::string LoadTextFile(const std::string& filename)
+{
+    std::string text;
 
-    std::ostringstream text;
-    size_t totalRead = 0u;
+    const char* const pOverrideDirectory = std::getenv("COLORWHEEL_SHADER_DIR");
+    if (nullptr != pOverrideDirectory)
     {
-        std::array<char, BufferSize> buffer;
-        std::ifstream ifs(fullpath);
-        while (ifs)
+        const auto overridePath = std::string(pOverrideDirectory) + "/" + filename;
+        if (ReadTextFile(overridePath, text))
         {
-            ifs.read(&buffer[0], buffer.size());
-            auto charsRead = ifs.gcount();
-            text.write(&buffer[0], charsRead);
-            totalRead += charsRead;
+            std::cout << "Loaded: " << overridePath << std::endl;
+            return text;
         }
     }
 
-    std::cout << "Read " << totalRead << " bytes." << std::endl;
+    for (const auto& embedded : EmbeddedShaders)
+    {
+        if (filename == embedded.pName)
+        {
+            return std::string(embedded.pText, embedded.size);
+        }
+    }
 
-    return text.str();
+    // Not embedded (yet); look beside the executable.
+    const std::string fullpath(sdl::GetExecutablePath().get() + filename);
+    if (!ReadTextFile(fullpath, text))
+    {
+        std::cerr << "Couldn't load: " << fullpath << std::endl;
+    }
+    return text;
 }
 
 
@@ -66,7 +107,6 @@ void ResetModelView(const glm::ivec2 windowClientSize, const float verticalFov,
 program_ptr InitializeGraphics(
     const glm::ivec2 windowClientSize,
     const float verticalFov,
-    GLuint& vertexArrayObjectName,
     GLint& projectionMatrixLocation,
     GLint& modelViewMatrixLocation,
     GLint& colorBlendTLocation,
@@ -85,18 +125,6 @@ program_ptr InitializeGraphics(
     ::glViewport(0, 0, windowClientSize.x, windowClientSize.y);
     gl::AssertNoErrors();
     
-    // Create the OpenGL buffer objects
-    ///////////////////////////////////
-    {
-        ::glGenVertexArrays(1, &vertexArrayObjectName);
-        gl::VerifyNoErrors();
-        
-        std::cout << "Vertex Array ID: " << vertexArrayObjectName << std::endl;
-        
-        ::glBindVertexArray(vertexArrayObjectName);
-        gl::VerifyNoErrors();
-    }
-    
     // Load the shader programs
     ///////////////////////////
     gl::Shader vertexShader(gl::ShaderType::Vertex);
@@ -135,13 +163,6 @@ program_ptr InitializeGraphics(
         std::cout << pShader->GetLinkerOrValidationOutput() << std::endl << std::endl;
     }
     
-    {
-        std::cout << "Validating complete shader program: ";
-        pShader->Validate();
-        std::cout << (pShader->IsValid() ? "SUCCESS" : "FAILED") << std::endl;
-        std::cout << pShader->GetLinkerOrValidationOutput() << std::endl << std::endl;
-    }
-    
     pShader->Use(); // NOTE: Easy step to forget.
     
     ///////////////////////
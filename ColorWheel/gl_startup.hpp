@@ -18,7 +18,6 @@ void ResetModelView(const glm::ivec2 windowClientSize, const float verticalFov,
 program_ptr InitializeGraphics(
     const glm::ivec2 windowClientSize,
     const float verticalFov,
-    GLuint& vertexArrayObjectName,
     GLint& projectionMatrixLocation,
     GLint& modelViewMatrixLocation,
     GLint& colorBlendTLocation,
@@ -0,0 +1,311 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_STATE_CACHE_HPP
+#define GL_STATE_CACHE_HPP
+
+#include <cstdint>
+#include <opengl/gl3.h>
+
+
+namespace gl
+{
+
+    // The number of binding calls sent to the driver versus skipped because the requested object
+    // was already bound.
+    struct StateChangeCounts
+    {
+        std::uint32_t issued;
+        std::uint32_t elided;
+    };
+
+    // OpenGL binding state tracker
+    ///////////////////////////////
+    // Shadows the program, vertex array, buffer, texture, and framebuffer bindings of the current
+    // context so that binds of already-current objects never reach the driver. Every bind in the
+    // application must go through this cache; after any code binds objects behind its back, call
+    // Invalidate().
+    class StateCache
+    {
+    public:
+        static StateCache& Instance() noexcept
+        {
+            static StateCache instance;
+            return instance;
+        }
+
+        // Forget all shadowed state; the next bind of each kind will always be issued.
+        void Invalidate() noexcept
+        {
+            _program = Unknown;
+            _vertexArray = Unknown;
+            _drawFramebuffer = Unknown;
+            _readFramebuffer = Unknown;
+            for (auto& buffer : _buffers)
+            {
+                buffer = Unknown;
+            }
+            _activeTextureUnit = Unknown;
+            for (auto& texture : _textures2d)
+            {
+                texture = Unknown;
+            }
+        }
+
+        // Starts a new frame of statistics; the counts from the frame just ended are retained.
+        void BeginFrame() noexcept
+        {
+            _lastFrame = _currentFrame;
+            _currentFrame = StateChangeCounts { 0u, 0u };
+        }
+
+        // Returns: the counts accumulated during the last complete frame.
+        const StateChangeCounts& LastFrameCounts() const noexcept
+        {
+            return _lastFrame;
+        }
+
+        // Returns: true, if glUseProgram was issued.
+        bool UseProgram(const GLuint programName) noexcept
+        {
+            if (!Update(_program, programName))
+            {
+                return false;
+            }
+            ::glUseProgram(programName);
+            return true;
+        }
+
+        // Returns: true, if glBindVertexArray was issued.
+        bool BindVertexArray(const GLuint vertexArrayName) noexcept
+        {
+            if (!Update(_vertexArray, vertexArrayName))
+            {
+                return false;
+            }
+            ::glBindVertexArray(vertexArrayName);
+
+            // The element array binding is part of the vertex array object's state.
+            _buffers[ElementArraySlot] = Unknown;
+            return true;
+        }
+
+        // Returns: true, if glBindBuffer was issued.
+        bool BindBuffer(const GLenum target, const GLuint bufferName) noexcept
+        {
+            const auto slot = BufferSlot(target);
+            if (slot < BufferSlotCount && !Update(_buffers[slot], bufferName))
+            {
+                return false;
+            }
+            if (slot >= BufferSlotCount)
+            {
+                ++_currentFrame.issued;
+            }
+            ::glBindBuffer(target, bufferName);
+            return true;
+        }
+
+        // Returns: true, if glActiveTexture was issued.
+        bool ActiveTexture(const GLenum textureUnit) noexcept
+        {
+            if (!Update(_activeTextureUnit, textureUnit))
+            {
+                return false;
+            }
+            ::glActiveTexture(textureUnit);
+            return true;
+        }
+
+        // Only GL_TEXTURE_2D bindings on the first TextureUnitCount units are shadowed; binds to
+        // other targets are always issued.
+        // Returns: true, if glBindTexture was issued.
+        bool BindTexture(const GLenum target, const GLuint textureName) noexcept
+        {
+            auto* const pSlot = Texture2dSlot(target);
+            if (nullptr != pSlot && !Update(*pSlot, textureName))
+            {
+                return false;
+            }
+            if (nullptr == pSlot)
+            {
+                ++_currentFrame.issued;
+            }
+            ::glBindTexture(target, textureName);
+            return true;
+        }
+
+        // GL_FRAMEBUFFER binds both the draw and read targets.
+        // Returns: true, if glBindFramebuffer was issued.
+        bool BindFramebuffer(const GLenum target, const GLuint framebufferName) noexcept
+        {
+            bool isChanged = false;
+            if (GL_FRAMEBUFFER == target)
+            {
+                // NOTE: Non-short-circuiting so both targets are updated and counted once each.
+                isChanged = Update(_drawFramebuffer, framebufferName) |
+                    Update(_readFramebuffer, framebufferName);
+            }
+            else if (GL_DRAW_FRAMEBUFFER == target)
+            {
+                isChanged = Update(_drawFramebuffer, framebufferName);
+            }
+            else
+            {
+                isChanged = Update(_readFramebuffer, framebufferName);
+            }
+
+            if (isChanged)
+            {
+                ::glBindFramebuffer(target, framebufferName);
+            }
+            return isChanged;
+        }
+
+        // Deleting a bound program doesn't unbind it; forget it so the name can be safely reused.
+        void ProgramDeleted(const GLuint programName) noexcept
+        {
+            if (programName == _program)
+            {
+                _program = Unknown;
+            }
+        }
+
+        // OpenGL reverts the binding of a deleted vertex array object to zero.
+        void VertexArrayDeleted(const GLuint vertexArrayName) noexcept
+        {
+            if (vertexArrayName == _vertexArray)
+            {
+                _vertexArray = 0u;
+                _buffers[ElementArraySlot] = Unknown;
+            }
+        }
+
+        // OpenGL reverts every binding of a deleted buffer object to zero.
+        void BufferDeleted(const GLuint bufferName) noexcept
+        {
+            for (auto& buffer : _buffers)
+            {
+                if (bufferName == buffer)
+                {
+                    buffer = 0u;
+                }
+            }
+        }
+
+        // OpenGL reverts the bindings of a deleted framebuffer object to zero.
+        void FramebufferDeleted(const GLuint framebufferName) noexcept
+        {
+            if (framebufferName == _drawFramebuffer)
+            {
+                _drawFramebuffer = 0u;
+            }
+            if (framebufferName == _readFramebuffer)
+            {
+                _readFramebuffer = 0u;
+            }
+        }
+
+        // OpenGL reverts every binding of a deleted texture to zero.
+        void TextureDeleted(const GLuint textureName) noexcept
+        {
+            for (auto& texture : _textures2d)
+            {
+                if (textureName == texture)
+                {
+                    texture = 0u;
+                }
+            }
+        }
+
+        // Not copyable.
+        StateCache(const StateCache&) = delete;
+        StateCache& operator =(const StateCache&) = delete;
+
+    private:
+        static const GLuint Unknown = ~0u;
+
+        enum : std::size_t
+        {
+            ArraySlot,
+            ElementArraySlot,
+            CopyReadSlot,
+            CopyWriteSlot,
+            PixelPackSlot,
+            PixelUnpackSlot,
+            UniformSlot,
+            BufferSlotCount
+        };
+
+        static const std::size_t TextureUnitCount = 16u;
+
+        StateCache() noexcept
+            : _currentFrame { 0u, 0u }
+            , _lastFrame { 0u, 0u }
+        {
+            Invalidate();
+        }
+
+        // Returns: true, if the shadowed value changed and the GL call must be issued.
+        bool Update(GLuint& shadow, const GLuint value) noexcept
+        {
+            if (value == shadow)
+            {
+                ++_currentFrame.elided;
+                return false;
+            }
+            shadow = value;
+            ++_currentFrame.issued;
+            return true;
+        }
+
+        static std::size_t BufferSlot(const GLenum target) noexcept
+        {
+            switch (target)
+            {
+                case GL_ARRAY_BUFFER:
+                    return ArraySlot;
+                case GL_ELEMENT_ARRAY_BUFFER:
+                    return ElementArraySlot;
+                case GL_COPY_READ_BUFFER:
+                    return CopyReadSlot;
+                case GL_COPY_WRITE_BUFFER:
+                    return CopyWriteSlot;
+                case GL_PIXEL_PACK_BUFFER:
+                    return PixelPackSlot;
+                case GL_PIXEL_UNPACK_BUFFER:
+                    return PixelUnpackSlot;
+                case GL_UNIFORM_BUFFER:
+                    return UniformSlot;
+                default:
+                    break;
+            }
+            return BufferSlotCount;
+        }
+
+        GLuint* Texture2dSlot(const GLenum target) noexcept
+        {
+            if (GL_TEXTURE_2D != target || Unknown == _activeTextureUnit)
+            {
+                return nullptr;
+            }
+            const auto unit = static_cast<std::size_t>(_activeTextureUnit - GL_TEXTURE0);
+            return unit < TextureUnitCount ? &_textures2d[unit] : nullptr;
+        }
+
+        GLuint _program;
+        GLuint _vertexArray;
+        GLuint _buffers[BufferSlotCount];
+        GLuint _activeTextureUnit;
+        GLuint _textures2d[TextureUnitCount];
+        GLuint _drawFramebuffer;
+        GLuint _readFramebuffer;
+
+        StateChangeCounts _currentFrame;
+        StateChangeCounts _lastFrame;
+    };
+
+} // namespace gl
+
+
+#endif
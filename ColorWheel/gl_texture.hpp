@@ -0,0 +1,462 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_TEXTURE_HPP
+#define GL_TEXTURE_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <opengl/gl3.h>
+#include "gl_exceptions.hpp"
+#include "gl_state_cache.hpp"
+
+
+namespace gl { namespace impl
+{
+
+    inline GLuint GenerateTextureName() noexcept
+    {
+        GLuint result = 0;
+        ::glGenTextures(1, &result);
+        return result;
+    }
+
+    inline void DeleteTextureName(const GLuint textureName) noexcept
+    {
+        ::glDeleteTextures(1, &textureName);
+        StateCache::Instance().TextureDeleted(textureName);
+    }
+
+} // namespace impl
+
+    // Sized internal formats for texture storage.
+    enum class TextureFormat
+        : GLenum
+    {
+        Invalid             = GL_INVALID_ENUM,
+        R8                  = GL_R8,
+        Rg8                 = GL_RG8,
+        Rgb8                = GL_RGB8,
+        Rgba8               = GL_RGBA8,
+        Srgb8Alpha8         = GL_SRGB8_ALPHA8,
+        R16f                = GL_R16F,
+        Rgba16f             = GL_RGBA16F,
+        R32f                = GL_R32F,
+        Rgba32f             = GL_RGBA32F,
+        Depth24             = GL_DEPTH_COMPONENT24,
+        Depth24Stencil8     = GL_DEPTH24_STENCIL8,
+    };
+
+    // Convert the TextureFormat enumeration to a string.
+    inline std::string TextureFormatToString(const TextureFormat textureFormat)
+    {
+        switch (textureFormat)
+        {
+            case TextureFormat::R8:
+                return "R8";
+            case TextureFormat::Rg8:
+                return "Rg8";
+            case TextureFormat::Rgb8:
+                return "Rgb8";
+            case TextureFormat::Rgba8:
+                return "Rgba8";
+            case TextureFormat::Srgb8Alpha8:
+                return "Srgb8Alpha8";
+            case TextureFormat::R16f:
+                return "R16f";
+            case TextureFormat::Rgba16f:
+                return "Rgba16f";
+            case TextureFormat::R32f:
+                return "R32f";
+            case TextureFormat::Rgba32f:
+                return "Rgba32f";
+            case TextureFormat::Depth24:
+                return "Depth24";
+            case TextureFormat::Depth24Stencil8:
+                return "Depth24Stencil8";
+            default:
+                break;
+        }
+        return "Invalid";
+    }
+
+    enum class TextureFilter
+        : GLint
+    {
+        Nearest                 = GL_NEAREST,
+        Linear                  = GL_LINEAR,
+        NearestMipmapNearest    = GL_NEAREST_MIPMAP_NEAREST,
+        LinearMipmapNearest     = GL_LINEAR_MIPMAP_NEAREST,
+        NearestMipmapLinear     = GL_NEAREST_MIPMAP_LINEAR,
+        LinearMipmapLinear      = GL_LINEAR_MIPMAP_LINEAR,
+    };
+
+    enum class TextureWrap
+        : GLint
+    {
+        ClampToEdge     = GL_CLAMP_TO_EDGE,
+        Repeat          = GL_REPEAT,
+        MirroredRepeat  = GL_MIRRORED_REPEAT,
+    };
+
+namespace impl
+{
+
+    // Returns: a pixel transfer format and type compatible with the sized internal format; used to
+    //              allocate storage without uploading any data.
+    inline std::pair<GLenum, GLenum> TransferFormatAndType(const TextureFormat textureFormat) noexcept
+    {
+        switch (textureFormat)
+        {
+            case TextureFormat::R8:
+                return std::make_pair(GL_RED, GL_UNSIGNED_BYTE);
+            case TextureFormat::Rg8:
+                return std::make_pair(GL_RG, GL_UNSIGNED_BYTE);
+            case TextureFormat::Rgb8:
+                return std::make_pair(GL_RGB, GL_UNSIGNED_BYTE);
+            case TextureFormat::Rgba8:
+            case TextureFormat::Srgb8Alpha8:
+                return std::make_pair(GL_RGBA, GL_UNSIGNED_BYTE);
+            case TextureFormat::R16f:
+            case TextureFormat::R32f:
+                return std::make_pair(GL_RED, GL_FLOAT);
+            case TextureFormat::Rgba16f:
+            case TextureFormat::Rgba32f:
+                return std::make_pair(GL_RGBA, GL_FLOAT);
+            case TextureFormat::Depth24:
+                return std::make_pair(GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+            case TextureFormat::Depth24Stencil8:
+                return std::make_pair(GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+            default:
+                break;
+        }
+        return std::make_pair(GL_INVALID_ENUM, GL_INVALID_ENUM);
+    }
+
+} // namespace impl
+
+    // OpenGL Texture Name wrapper
+    //////////////////////////////
+    class TextureName
+    {
+    public:
+        typedef GLuint          value_type;
+        typedef value_type&     reference;
+
+        TextureName()
+            : _handle(impl::GenerateTextureName())
+        {
+            if (0u == _handle)
+            {
+                throw std::runtime_error("failed to generate an OpenGL texture name");
+            }
+        }
+
+        TextureName(TextureName&& original) noexcept
+            : _handle(0u)
+        {
+            std::swap(original._handle, _handle);
+        }
+
+        virtual ~TextureName()
+        {
+            impl::DeleteTextureName(_handle);
+        }
+
+        TextureName& operator =(TextureName&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            impl::DeleteTextureName(_handle);
+            _handle = 0u;
+
+            std::swap(rhs._handle, _handle);
+
+            return *this;
+        }
+
+        operator value_type() const noexcept
+        {
+            return _handle;
+        }
+
+        // Not copyable.
+        TextureName(const TextureName&) = delete;
+        TextureName& operator =(const TextureName&) = delete;
+
+    private:
+        value_type _handle;
+    };
+
+    // OpenGL 2D Texture wrapper
+    ////////////////////////////
+    // Storage is allocated once, for every mip level up front, and can't be respecified afterwards;
+    // only its contents can change. glTexStorage2D isn't available in a 3.2 core context, so the
+    // levels are allocated individually and the base / max levels are pinned to match, which leaves
+    // the texture mipmap complete from the moment it's allocated.
+    // NOTE: Every method binds the texture to the active texture unit (through the StateCache).
+    class Texture
+    {
+    public:
+        Texture()
+            : _format(TextureFormat::Invalid)
+            , _width(0)
+            , _height(0)
+            , _levels(0)
+        {
+        }
+
+        Texture(Texture&& original) noexcept
+            : _name(std::move(original._name))
+            , _format(original._format)
+            , _width(original._width)
+            , _height(original._height)
+            , _levels(original._levels)
+        {
+            original._format = TextureFormat::Invalid;
+            original._width = 0;
+            original._height = 0;
+            original._levels = 0;
+        }
+
+        virtual ~Texture()
+        {
+        }
+
+        Texture& operator =(Texture&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            _name = std::move(rhs._name);
+            _format = rhs._format;
+            _width = rhs._width;
+            _height = rhs._height;
+            _levels = rhs._levels;
+
+            rhs._format = TextureFormat::Invalid;
+            rhs._width = 0;
+            rhs._height = 0;
+            rhs._levels = 0;
+
+            return *this;
+        }
+
+        GLuint Name() const noexcept
+        {
+            return _name;
+        }
+
+        // Returns: the number of levels in a complete mipmap chain for the given base size.
+        static GLsizei FullMipChainLevels(GLsizei width, GLsizei height) noexcept
+        {
+            GLsizei levels = 1;
+            while (width > 1 || height > 1)
+            {
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+                ++levels;
+            }
+            return levels;
+        }
+
+        void Bind() const noexcept
+        {
+            StateCache::Instance().BindTexture(GL_TEXTURE_2D, _name);
+        }
+
+        static void Unbind() noexcept
+        {
+            StateCache::Instance().BindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        // Allocates immutable storage for levels mip levels, starting at width x height.
+        // Throws:  std::logic_error : storage was already allocated.
+        //          InvalidValue : width, height, or levels are less than 1; -or-, levels is more
+        //              than the full mipmap chain.
+        //          OutOfMemory
+        void Storage(
+            const TextureFormat textureFormat,
+            const GLsizei width,
+            const GLsizei height,
+            const GLsizei levels = 1
+            )
+        {
+            if (IsAllocated())
+            {
+                throw std::logic_error("texture storage is immutable once allocated");
+            }
+
+            if (width < 1 || height < 1 || levels < 1 || levels > FullMipChainLevels(width, height))
+            {
+                throw InvalidValue();
+            }
+
+            const auto transfer = impl::TransferFormatAndType(textureFormat);
+
+            Bind();
+
+            auto levelWidth = width;
+            auto levelHeight = height;
+            for (GLint level = 0; level < levels; ++level)
+            {
+                ::glTexImage2D(
+                    GL_TEXTURE_2D,
+                    level,
+                    static_cast<GLint>(textureFormat),
+                    levelWidth,
+                    levelHeight,
+                    0,
+                    transfer.first,
+                    transfer.second,
+                    nullptr
+                    );
+                levelWidth = std::max(1, levelWidth / 2);
+                levelHeight = std::max(1, levelHeight / 2);
+            }
+
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+            // NOTE: An InvalidEnum here indicates a programming error.
+            VerifyNoErrors();
+
+            _format = textureFormat;
+            _width = width;
+            _height = height;
+            _levels = levels;
+        }
+
+        // Replaces a rectangle of one mip level's contents.
+        // Throws:  InvalidValue : the rectangle is beyond the level's bounds; -or-, level isn't
+        //              an allocated level.
+        //          InvalidOperation : storage hasn't been allocated; -or-, format and type aren't
+        //              compatible with the texture's format.
+        void SubImage(
+            const GLint level,
+            const GLint x,
+            const GLint y,
+            const GLsizei width,
+            const GLsizei height,
+            const GLenum format,
+            const GLenum type,
+            const void* const pixels
+            )
+        {
+            if (!IsAllocated())
+            {
+                throw InvalidOperation();
+            }
+
+            if (level < 0 || level >= _levels)
+            {
+                throw InvalidValue();
+            }
+
+            Bind();
+            ::glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels);
+            VerifyNoErrors();
+        }
+
+        // Regenerates levels 1 and up from the contents of level 0.
+        // Throws:  InvalidOperation : storage hasn't been allocated.
+        void GenerateMipmaps()
+        {
+            if (!IsAllocated())
+            {
+                throw InvalidOperation();
+            }
+
+            Bind();
+            ::glGenerateMipmap(GL_TEXTURE_2D);
+            VerifyNoErrors();
+        }
+
+        // Throws:  InvalidEnum : a mipmapped minification filter was chosen for a texture with a
+        //              single level (it would sample as incomplete).
+        void SetFilters(const TextureFilter minFilter, const TextureFilter magFilter)
+        {
+            const auto isMipmapped = TextureFilter::Nearest != minFilter &&
+                TextureFilter::Linear != minFilter;
+            if (isMipmapped && _levels <= 1)
+            {
+                throw InvalidEnum();
+            }
+
+            Bind();
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(minFilter));
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(magFilter));
+            VerifyNoErrors();
+        }
+
+        void SetWrap(const TextureWrap s, const TextureWrap t)
+        {
+            Bind();
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLint>(s));
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLint>(t));
+            VerifyNoErrors();
+        }
+
+        // Restricts sampling to the allocated levels baseLevel through maxLevel.
+        // Throws:  InvalidValue : the range is empty or outside the allocated levels.
+        void SetMipRange(const GLint baseLevel, const GLint maxLevel)
+        {
+            if (baseLevel < 0 || maxLevel < baseLevel || maxLevel >= _levels)
+            {
+                throw InvalidValue();
+            }
+
+            Bind();
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+            ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+            VerifyNoErrors();
+        }
+
+        bool IsAllocated() const noexcept
+        {
+            return 0 != _levels;
+        }
+
+        TextureFormat Format() const noexcept
+        {
+            return _format;
+        }
+
+        GLsizei Width() const noexcept
+        {
+            return _width;
+        }
+
+        GLsizei Height() const noexcept
+        {
+            return _height;
+        }
+
+        GLsizei Levels() const noexcept
+        {
+            return _levels;
+        }
+
+        // Not copyable.
+        Texture(const Texture&) = delete;
+        Texture& operator =(const Texture&) = delete;
+
+    private:
+        TextureName _name;
+        TextureFormat _format;
+        GLsizei _width;
+        GLsizei _height;
+        GLsizei _levels;
+    };
+
+} // namespace gl
+
+
+#endif
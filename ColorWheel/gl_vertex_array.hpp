@@ -0,0 +1,482 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GL_VERTEX_ARRAY_HPP
+#define GL_VERTEX_ARRAY_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <opengl/gl3.h>
+#include <glm/glm.hpp>
+#include "gl_exceptions.hpp"
+#include "gl_state_cache.hpp"
+#include "gl_buffer_object.hpp"
+
+
+namespace gl { namespace impl
+{
+
+    inline GLuint GenerateVertexArrayName() noexcept
+    {
+        GLuint result = 0;
+        ::glGenVertexArrays(1, &result);
+        return result;
+    }
+
+    inline void DeleteVertexArrayName(const GLuint vertexArrayName) noexcept
+    {
+        ::glDeleteVertexArrays(1, &vertexArrayName);
+        StateCache::Instance().VertexArrayDeleted(vertexArrayName);
+    }
+
+    // The GL scalar type of a vertex attribute component.
+    template<typename T>
+    struct ScalarTraits;
+
+#define GL_SCALAR_TRAITS(scalar_t, gl_type, is_integer, is_unsigned)\
+    template<>\
+    struct ScalarTraits<scalar_t>\
+    {\
+        static const GLenum type = gl_type;\
+        static const bool isInteger = is_integer;\
+        static const bool isUnsigned = is_unsigned;\
+    };
+
+    GL_SCALAR_TRAITS(GLfloat, GL_FLOAT, false, false)
+    GL_SCALAR_TRAITS(GLbyte, GL_BYTE, true, false)
+    GL_SCALAR_TRAITS(GLubyte, GL_UNSIGNED_BYTE, true, true)
+    GL_SCALAR_TRAITS(GLshort, GL_SHORT, true, false)
+    GL_SCALAR_TRAITS(GLushort, GL_UNSIGNED_SHORT, true, true)
+    GL_SCALAR_TRAITS(GLint, GL_INT, true, false)
+    GL_SCALAR_TRAITS(GLuint, GL_UNSIGNED_INT, true, true)
+
+#undef GL_SCALAR_TRAITS
+
+    // The kind of value a vertex shader input variable reads.
+    enum class ShaderInputKind
+    {
+        Float,
+        Int,
+        UnsignedInt,
+    };
+
+    // Decomposes a glGetActiveAttrib type into its kind and component count.
+    // Returns: false, if the type isn't a scalar or vector (e.g.: a matrix).
+    inline bool DecomposeShaderInputType(
+        const GLenum type,
+        ShaderInputKind& kind,
+        GLint& components
+        ) noexcept
+    {
+        switch (type)
+        {
+            case GL_FLOAT:              kind = ShaderInputKind::Float; components = 1; return true;
+            case GL_FLOAT_VEC2:         kind = ShaderInputKind::Float; components = 2; return true;
+            case GL_FLOAT_VEC3:         kind = ShaderInputKind::Float; components = 3; return true;
+            case GL_FLOAT_VEC4:         kind = ShaderInputKind::Float; components = 4; return true;
+            case GL_INT:                kind = ShaderInputKind::Int; components = 1; return true;
+            case GL_INT_VEC2:           kind = ShaderInputKind::Int; components = 2; return true;
+            case GL_INT_VEC3:           kind = ShaderInputKind::Int; components = 3; return true;
+            case GL_INT_VEC4:           kind = ShaderInputKind::Int; components = 4; return true;
+            case GL_UNSIGNED_INT:       kind = ShaderInputKind::UnsignedInt; components = 1; return true;
+            case GL_UNSIGNED_INT_VEC2:  kind = ShaderInputKind::UnsignedInt; components = 2; return true;
+            case GL_UNSIGNED_INT_VEC3:  kind = ShaderInputKind::UnsignedInt; components = 3; return true;
+            case GL_UNSIGNED_INT_VEC4:  kind = ShaderInputKind::UnsignedInt; components = 4; return true;
+            default:
+                break;
+        }
+        return false;
+    }
+
+} // namespace impl
+
+    // Tags an integer attribute type whose components are converted to floats in [0, 1] (unsigned)
+    // or [-1, 1] (signed) as they're read by the vertex shader; e.g.: Normalized<glm::u8vec4> for
+    // an RGBA8 color.
+    template<typename T>
+    struct Normalized
+    {
+    };
+
+    // Compile time description of one vertex attribute: a scalar or glm::tvec of GL scalars.
+    template<typename T>
+    struct AttributeTraits
+    {
+        typedef T storage_type;
+        typedef impl::ScalarTraits<T> scalar_traits;
+
+        static const GLint components = 1;
+        static const bool isNormalized = false;
+    };
+
+#define GL_VECTOR_ATTRIBUTE_TRAITS(element_count)\
+    template<typename T, glm::precision P>\
+    struct AttributeTraits<glm::tvec##element_count<T, P>>\
+    {\
+        typedef glm::tvec##element_count<T, P> storage_type;\
+        typedef impl::ScalarTraits<T> scalar_traits;\
+\
+        static_assert(\
+            sizeof(storage_type) == element_count * sizeof(T),\
+            "vector attributes must be tightly packed"\
+            );\
+\
+        static const GLint components = element_count;\
+        static const bool isNormalized = false;\
+    };
+
+    GL_VECTOR_ATTRIBUTE_TRAITS(2)
+    GL_VECTOR_ATTRIBUTE_TRAITS(3)
+    GL_VECTOR_ATTRIBUTE_TRAITS(4)
+
+#undef GL_VECTOR_ATTRIBUTE_TRAITS
+
+    template<typename T>
+    struct AttributeTraits<Normalized<T>>
+    {
+        typedef typename AttributeTraits<T>::storage_type storage_type;
+        typedef typename AttributeTraits<T>::scalar_traits scalar_traits;
+
+        static_assert(scalar_traits::isInteger, "only integer attributes can be normalized");
+
+        static const GLint components = AttributeTraits<T>::components;
+        static const bool isNormalized = true;
+    };
+
+    // One attribute of a VertexLayout, as passed to glVertexAttrib[I]Pointer.
+    struct VertexAttribute
+    {
+        GLuint          location;
+        GLuint          bufferName;
+        GLint           components;
+        GLenum          type;
+        bool            isNormalized;
+        bool            isInteger;      // Read as an int/uint (not converted to float) by the shader.
+        bool            isUnsigned;
+        GLsizei         stride;
+        std::size_t     offset;
+    };
+
+    // Vertex Layout descriptor
+    ///////////////////////////
+    // The set of attributes a VertexArray pulls from its buffer objects. Component counts, GL types,
+    // strides, and normalization are deduced from the attribute types at compile time, e.g.:
+    //
+    // struct Vertex
+    // {
+    //     glm::vec2 position;
+    //     glm::u8vec4 color;
+    // };
+    //
+    // gl::VertexLayout layout;
+    // layout
+    //     .Add<glm::vec2, Vertex>(PositionLocation, buffer, offsetof(Vertex, position))
+    //     .Add<gl::Normalized<glm::u8vec4>, Vertex>(ColorLocation, buffer, offsetof(Vertex, color))
+    //     .Add<GLfloat>(SaturationLocation, saturationBuffer);  // A separate, tightly packed buffer.
+    //
+    class VertexLayout
+    {
+    public:
+        typedef BufferObject<BufferObjectType::Array> array_buffer;
+
+        // Adds an attribute of type attribute_t read at offset bytes into every vertex_t element of
+        // buffer. By default, the buffer holds nothing but attribute_t values.
+        // Throws:  std::logic_error : the attribute doesn't fit inside vertex_t at offset; -or-,
+        //              location is already part of this layout.
+        //          std::bad_alloc
+        template<
+            typename attribute_t,
+            typename vertex_t = typename AttributeTraits<attribute_t>::storage_type
+            >
+        VertexLayout& Add(
+            const GLuint location,
+            const array_buffer& buffer,
+            const std::size_t offset = 0u
+            )
+        {
+            typedef AttributeTraits<attribute_t> traits;
+            typedef typename traits::scalar_traits scalar_traits;
+
+            if (offset + sizeof(typename traits::storage_type) > sizeof(vertex_t))
+            {
+                throw std::logic_error("vertex attribute extends past the end of its vertex");
+            }
+
+            if (nullptr != Find(location))
+            {
+                throw std::logic_error("vertex attribute location is already part of the layout");
+            }
+
+            _attributes.push_back(VertexAttribute {
+                location,
+                buffer.Name(),
+                traits::components,
+                scalar_traits::type,
+                traits::isNormalized,
+                scalar_traits::isInteger && !traits::isNormalized,
+                scalar_traits::isUnsigned,
+                static_cast<GLsizei>(sizeof(vertex_t)),
+                offset
+                });
+
+            return *this;
+        }
+
+        const std::vector<VertexAttribute>& Attributes() const noexcept
+        {
+            return _attributes;
+        }
+
+        // Returns: the attribute bound to location; or, nullptr.
+        const VertexAttribute* Find(const GLuint location) const noexcept
+        {
+            for (const auto& attribute : _attributes)
+            {
+                if (location == attribute.location)
+                {
+                    return &attribute;
+                }
+            }
+            return nullptr;
+        }
+
+        // Checks that every active vertex shader input of program is fed by this layout with a
+        // compatible type: the same kind of value (float, int, or uint), and no more components
+        // than the shader reads.
+        // Throws:  std::runtime_error : an active attribute is missing or mismatched; what()
+        //              names it.
+        //          InvalidOperation : the program hasn't been linked.
+        //          std::bad_alloc
+        template<typename program_t>
+        void Validate(const program_t& program) const
+        {
+            const auto count = program.GetActiveAttributeCount();
+            for (GLint i = 0; i < count; ++i)
+            {
+                GLint size = 0;
+                GLenum type = GL_NONE;
+                const auto name = program.GetActiveAttribute(static_cast<GLuint>(i), size, type);
+
+                // Built-ins like gl_VertexID aren't sourced from buffers.
+                if (0u == name.compare(0u, 3u, "gl_"))
+                {
+                    continue;
+                }
+
+                const auto location = program.GetAttributeLocation(name);
+                const auto* const pAttribute = location < 0 ?
+                    nullptr : Find(static_cast<GLuint>(location));
+                if (nullptr == pAttribute)
+                {
+                    throw std::runtime_error("vertex layout doesn't provide attribute: " + name);
+                }
+
+                impl::ShaderInputKind kind;
+                GLint components = 0;
+                if (!impl::DecomposeShaderInputType(type, kind, components))
+                {
+                    throw std::runtime_error("vertex layout can't feed the type of attribute: " + name);
+                }
+
+                const auto attributeKind = !pAttribute->isInteger ? impl::ShaderInputKind::Float :
+                    pAttribute->isUnsigned ? impl::ShaderInputKind::UnsignedInt :
+                    impl::ShaderInputKind::Int;
+                if (attributeKind != kind || pAttribute->components > components)
+                {
+                    throw std::runtime_error("vertex layout type doesn't match attribute: " + name);
+                }
+            }
+        }
+
+    private:
+        std::vector<VertexAttribute> _attributes;
+    };
+
+    // OpenGL Vertex Array Object Name wrapper
+    //////////////////////////////////////////
+    class VertexArrayName
+    {
+    public:
+        typedef GLuint          value_type;
+        typedef value_type&     reference;
+
+        VertexArrayName()
+            : _handle(impl::GenerateVertexArrayName())
+        {
+            if (0u == _handle)
+            {
+                throw std::runtime_error("failed to generate an OpenGL vertex array object name");
+            }
+        }
+
+        VertexArrayName(VertexArrayName&& original) noexcept
+            : _handle(0u)
+        {
+            std::swap(original._handle, _handle);
+        }
+
+        virtual ~VertexArrayName()
+        {
+            impl::DeleteVertexArrayName(_handle);
+        }
+
+        VertexArrayName& operator =(VertexArrayName&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            impl::DeleteVertexArrayName(_handle);
+            _handle = 0u;
+
+            std::swap(rhs._handle, _handle);
+
+            return *this;
+        }
+
+        operator value_type() const noexcept
+        {
+            return _handle;
+        }
+
+        // Not copyable.
+        VertexArrayName(const VertexArrayName&) = delete;
+        VertexArrayName& operator =(const VertexArrayName&) = delete;
+
+    private:
+        value_type _handle;
+    };
+
+    // OpenGL Vertex Array Object wrapper
+    /////////////////////////////////////
+    // NOTE: The vertex array doesn't own the buffer objects its layout refers to; they must outlive
+    // its use.
+    class VertexArray
+    {
+    public:
+        VertexArray()
+            : _enabledLocations(0u)
+        {
+        }
+
+        VertexArray(VertexArray&& original) noexcept
+            : _name(std::move(original._name))
+            , _enabledLocations(original._enabledLocations)
+        {
+            original._enabledLocations = 0u;
+        }
+
+        virtual ~VertexArray()
+        {
+        }
+
+        VertexArray& operator =(VertexArray&& rhs) noexcept
+        {
+            if (&rhs == this)
+            {
+                return *this;
+            }
+
+            _name = std::move(rhs._name);
+            _enabledLocations = rhs._enabledLocations;
+            rhs._enabledLocations = 0u;
+
+            return *this;
+        }
+
+        GLuint Name() const noexcept
+        {
+            return _name;
+        }
+
+        void Bind() const noexcept
+        {
+            StateCache::Instance().BindVertexArray(_name);
+        }
+
+        static void Unbind() noexcept
+        {
+            StateCache::Instance().BindVertexArray(0u);
+        }
+
+        // Points every attribute of layout at its buffer object and enables it; attributes enabled
+        // by a previous layout but absent from this one are disabled. Switching layouts is just
+        // another call.
+        // NOTE: Leaves this vertex array bound; the GL_ARRAY_BUFFER binding is left at the last
+        // attribute's buffer object.
+        // Throws:  InvalidValue : a location >= GL_MAX_VERTEX_ATTRIBS; -or-, a stride is negative.
+        //          InvalidOperation : a buffer object name has been deleted.
+        void SetLayout(const VertexLayout& layout)
+        {
+            Bind();
+
+            auto& stateCache = StateCache::Instance();
+            std::uint32_t enabledLocations = 0u;
+            for (const auto& attribute : layout.Attributes())
+            {
+                stateCache.BindBuffer(GL_ARRAY_BUFFER, attribute.bufferName);
+
+                const auto* const pOffset = reinterpret_cast<const GLvoid*>(attribute.offset);
+                if (attribute.isInteger)
+                {
+                    ::glVertexAttribIPointer(
+                        attribute.location,
+                        attribute.components,
+                        attribute.type,
+                        attribute.stride,
+                        pOffset
+                        );
+                }
+                else
+                {
+                    ::glVertexAttribPointer(
+                        attribute.location,
+                        attribute.components,
+                        attribute.type,
+                        attribute.isNormalized ? GL_TRUE : GL_FALSE,
+                        attribute.stride,
+                        pOffset
+                        );
+                }
+                VerifyNoErrors();
+
+                ::glEnableVertexAttribArray(attribute.location);
+                VerifyNoErrors();
+
+                if (attribute.location < 32u)
+                {
+                    enabledLocations |= 1u << attribute.location;
+                }
+            }
+
+            // Only the first 32 locations are tracked; GL 3.2 guarantees just 16.
+            const auto staleLocations = _enabledLocations & ~enabledLocations;
+            for (GLuint location = 0u; location < 32u; ++location)
+            {
+                if (0u != (staleLocations & (1u << location)))
+                {
+                    ::glDisableVertexAttribArray(location);
+                }
+            }
+            AssertNoErrors();
+
+            _enabledLocations = enabledLocations;
+        }
+
+        // Not copyable.
+        VertexArray(const VertexArray&) = delete;
+        VertexArray& operator =(const VertexArray&) = delete;
+
+    private:
+        VertexArrayName _name;
+        std::uint32_t _enabledLocations;
+    };
+
+} // namespace gl
+
+
+#endif
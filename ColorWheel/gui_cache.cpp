@@ -0,0 +1,376 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <opengl/gl3.h>         // Probably specific to OS X.
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>          // Vector and Matrix math.
+
+#include "gl_state_cache.hpp"
+#include "imgui/imgui.h"
+#include "imgui/imguiRenderGL3.h"
+#include "wheel_cache.hpp"
+
+#include "gui_cache.hpp"
+
+
+namespace
+{
+
+    const std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+    const std::uint64_t FnvPrime = 1099511628211ull;
+
+    void HashBytes(std::uint64_t& hash, const void* const pBytes, const std::size_t size) noexcept
+    {
+        const auto pByte = static_cast<const unsigned char*>(pBytes);
+        for (std::size_t i = 0u; i < size; ++i)
+        {
+            hash ^= pByte[i];
+            hash *= FnvPrime;
+        }
+    }
+
+    template<typename T>
+    void HashValue(std::uint64_t& hash, const T value) noexcept
+    {
+        HashBytes(hash, &value, sizeof(value));
+    }
+
+    // Hashes what a command draws; not its padding, nor where its text happens to be stored.
+    void HashCommand(std::uint64_t& hash, const imguiGfxCmd& command) noexcept
+    {
+        HashValue(hash, command.type);
+        HashValue(hash, command.flags);
+        HashValue(hash, command.col);
+        switch (command.type)
+        {
+        case IMGUI_GFXCMD_LINE:
+            HashValue(hash, command.line);
+            break;
+        case IMGUI_GFXCMD_TEXT:
+            HashValue(hash, command.text.x);
+            HashValue(hash, command.text.y);
+            HashValue(hash, command.text.align);
+            if (nullptr != command.text.text)
+            {
+                HashBytes(hash, command.text.text, std::strlen(command.text.text) + 1u);
+            }
+            break;
+        default:
+            HashValue(hash, command.rect);
+            break;
+        }
+    }
+
+    // Regions are x, y, width, height; an empty one has no width.
+    glm::ivec4 Union(const glm::ivec4& a, const glm::ivec4& b) noexcept
+    {
+        if (0 >= a.z)
+        {
+            return b;
+        }
+        if (0 >= b.z)
+        {
+            return a;
+        }
+
+        const auto x0 = std::min(a.x, b.x);
+        const auto y0 = std::min(a.y, b.y);
+        const auto x1 = std::max(a.x + a.z, b.x + b.z);
+        const auto y1 = std::max(a.y + a.w, b.y + b.w);
+        return glm::ivec4(x0, y0, x1 - x0, y1 - y0);
+    }
+
+    glm::ivec4 Intersection(const glm::ivec4& a, const glm::ivec4& b) noexcept
+    {
+        const auto x0 = std::max(a.x, b.x);
+        const auto y0 = std::max(a.y, b.y);
+        const auto x1 = std::min(a.x + a.z, b.x + b.z);
+        const auto y1 = std::min(a.y + a.w, b.y + b.w);
+        return (x0 < x1 && y0 < y1) ? glm::ivec4(x0, y0, x1 - x0, y1 - y0) : glm::ivec4(0);
+    }
+
+    // Anti-aliasing fringes reach a unit past the shapes; regions are cleared with this margin.
+    const int FringeMargin = 1;
+
+    // Returns: true, if a and b are within two margins of each other.
+    bool Intersects(const glm::ivec4& a, const glm::ivec4& b) noexcept
+    {
+        const auto gap = 2 * FringeMargin;
+        return 0 < a.z && 0 < b.z &&
+            a.x < b.x + b.z + gap && b.x < a.x + a.z + gap &&
+            a.y < b.y + b.w + gap && b.y < a.y + a.w + gap;
+    }
+
+    bool Contains(const glm::ivec4& region, const int x, const int y) noexcept
+    {
+        return region.x <= x && x < region.x + region.z && region.y <= y && y < region.y + region.w;
+    }
+
+    // Shapes are in eighths of a GUI unit.
+    glm::ivec4 ShapeBounds(const int x, const int y, const int width, const int height) noexcept
+    {
+        const auto x0 = x / 8;
+        const auto y0 = y / 8;
+        return glm::ivec4(x0, y0, (x + width + 7) / 8 - x0, (y + height + 7) / 8 - y0);
+    }
+
+    // imguiRenderGL3 draws text 15 units high; no glyph is wider than that, or reaches further above
+    // the baseline, or more than a third of it below.
+    const int FontSize = 15;
+    const int LastTabStop = 330;
+
+    // Returns: a region certain to hold command's text, without laying it out.
+    glm::ivec4 TextBounds(const imguiGfxText& text) noexcept
+    {
+        if (nullptr == text.text)
+        {
+            return glm::ivec4(0);
+        }
+
+        // Every byte of UTF-8 is counted as a whole glyph.
+        auto width = static_cast<int>(std::strlen(text.text)) * FontSize;
+        if (nullptr != std::strchr(text.text, '\t'))
+        {
+            width += LastTabStop;
+        }
+
+        auto x = static_cast<int>(text.x);
+        if (IMGUI_ALIGN_CENTER == text.align)
+        {
+            x -= width / 2 + 1;
+        }
+        else if (IMGUI_ALIGN_RIGHT == text.align)
+        {
+            x -= width;
+        }
+        return glm::ivec4(x - 1, text.y - FontSize / 3 - 1, width + 2, FontSize + FontSize / 3 + 2);
+    }
+
+    bool Contains(const glm::ivec4& region, const glm::ivec4& inner) noexcept
+    {
+        return region.x <= inner.x && inner.x + inner.z <= region.x + region.z &&
+            region.y <= inner.y && inner.y + inner.w <= region.y + region.w;
+    }
+
+} // namespace
+
+
+GuiCache::GuiCache(const glm::ivec2 drawableSize, const glm::ivec2 screenSize, const float pixelScale)
+    : _screenSize(screenSize)
+    , _pixelScale(pixelScale)
+    , _pCompositeProgram(CreateCompositeProgram())
+    , _textureLocation(_pCompositeProgram->GetUniformLocation("sourceTexture"))
+    , _panelsRedrawn(0u)
+{
+    // The composite is a 1:1 copy of texels to pixels; no mipmaps or filtering between them.
+    _colorTexture.Storage(gl::TextureFormat::Rgba8, drawableSize.x, drawableSize.y);
+    _colorTexture.SetFilters(gl::TextureFilter::Nearest, gl::TextureFilter::Nearest);
+    _colorTexture.SetWrap(gl::TextureWrap::ClampToEdge, gl::TextureWrap::ClampToEdge);
+
+    _framebuffer.AttachColor(_colorTexture);
+    _framebuffer.Validate();
+    gl::Framebuffer::Unbind();
+
+    _panels.reserve(16u);
+    _previousPanels.reserve(16u);
+}
+
+GuiCache::~GuiCache()
+{
+}
+
+void GuiCache::Draw(const imguiGfxCmd* const pCommands, const int count)
+{
+    FindPanels(pCommands, count);
+
+    // A panel is redrawn if it changed, or if it overlaps what's being cleared for one that did.
+    const auto isSameLayout = _panels.size() == _previousPanels.size();
+    for (std::size_t i = 0u; i < _panels.size(); ++i)
+    {
+        auto& panel = _panels[i];
+        panel.isDirty = !isSameLayout || panel.hash != _previousPanels[i].hash ||
+            panel.region != _previousPanels[i].region;
+    }
+
+    for (auto isSpreading = isSameLayout; isSpreading; )
+    {
+        isSpreading = false;
+        for (std::size_t i = 0u; i < _panels.size(); ++i)
+        {
+            if (!_panels[i].isDirty)
+            {
+                continue;
+            }
+
+            for (std::size_t j = 0u; j < _panels.size(); ++j)
+            {
+                auto& other = _panels[j];
+                if (!other.isDirty &&
+                    (Intersects(other.region, _panels[i].region) ||
+                     Intersects(other.region, _previousPanels[i].region)))
+                {
+                    other.isDirty = true;
+                    isSpreading = true;
+                }
+            }
+        }
+    }
+
+    _panelsRedrawn = 0u;
+    for (const auto& panel : _panels)
+    {
+        _panelsRedrawn += panel.isDirty ? 1u : 0u;
+    }
+
+    if (0u != _panelsRedrawn || !isSameLayout)
+    {
+        GLint savedViewport[4];
+        ::glGetIntegerv(GL_VIEWPORT, savedViewport);
+
+        _framebuffer.Bind();
+        ::glViewport(0, 0, _colorTexture.Width(), _colorTexture.Height());
+        ::glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+        if (isSameLayout)
+        {
+            for (std::size_t i = 0u; i < _panels.size(); ++i)
+            {
+                if (_panels[i].isDirty)
+                {
+                    ClearRegion(_previousPanels[i].region);
+                    ClearRegion(_panels[i].region);
+                }
+            }
+        }
+        else
+        {
+            ::glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        // Accumulate coverage in alpha the way it'd be composited over the window, so the texture
+        // ends up holding premultiplied color.
+        ::glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        for (const auto& panel : _panels)
+        {
+            if (panel.isDirty)
+            {
+                ::imguiRenderGLDraw(pCommands + panel.first, panel.count, _screenSize.x, _screenSize.y, _pixelScale);
+            }
+        }
+        ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        gl::Framebuffer::Unbind();
+        ::glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+        gl::VerifyNoErrors();
+    }
+
+    std::swap(_panels, _previousPanels);
+
+    auto& stateCache = gl::StateCache::Instance();
+
+    _pCompositeProgram->Use();
+    _pCompositeProgram->SetUniform(_textureLocation, 0);
+    stateCache.ActiveTexture(GL_TEXTURE0);
+    _colorTexture.Bind();
+    _emptyVertexArray.Bind();
+
+    ::glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    ::glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void GuiCache::FindPanels(const imguiGfxCmd* const pCommands, const int count)
+{
+    _panels.clear();
+    Panel panel { 0, 0, FnvOffsetBasis, glm::ivec4(0), false };
+    glm::ivec4 background(0);   // The current panel's scroll area, if it is one.
+    glm::ivec4 scissor(0);
+    auto isScissored = false;
+
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto& command = pCommands[i];
+
+        glm::ivec4 bounds(0);
+        switch (command.type)
+        {
+        case IMGUI_GFXCMD_RECT:
+        case IMGUI_GFXCMD_TRIANGLE:
+            bounds = ShapeBounds(command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+            break;
+        case IMGUI_GFXCMD_LINE:
+            bounds = ShapeBounds(
+                std::min(command.line.x0, command.line.x1) - command.line.r,
+                std::min(command.line.y0, command.line.y1) - command.line.r,
+                std::abs(command.line.x1 - command.line.x0) + 2 * command.line.r,
+                std::abs(command.line.y1 - command.line.y0) + 2 * command.line.r
+                );
+            break;
+        case IMGUI_GFXCMD_TEXT:
+            bounds = TextBounds(command.text);
+            break;
+        }
+
+        // imguiBeginScrollArea() starts with the area's rounded background, outside any scissor. The
+        // area's header and scroll bar are drawn inside it, but outside the scissor; anything else
+        // outside both starts a panel of its own.
+        const auto isScrollArea = IMGUI_GFXCMD_RECT == command.type && 0 != command.rect.r;
+        const auto isOutsideArea = 0 < background.z &&
+            (IMGUI_GFXCMD_TEXT == command.type ?
+                !Contains(background, command.text.x, command.text.y) : !Contains(background, bounds));
+        if (!isScissored && IMGUI_GFXCMD_SCISSOR != command.type && (isScrollArea || isOutsideArea))
+        {
+            if (i != panel.first)
+            {
+                panel.count = i - panel.first;
+                _panels.push_back(panel);
+            }
+            panel = Panel { i, 0, FnvOffsetBasis, glm::ivec4(0), false };
+            background = isScrollArea ? bounds : glm::ivec4(0);
+        }
+
+        if (IMGUI_GFXCMD_SCISSOR == command.type)
+        {
+            isScissored = 0 != command.flags;
+            scissor = glm::ivec4(command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+        }
+        else if (isScissored)
+        {
+            // Scrolled out of view.
+            bounds = Intersection(bounds, scissor);
+        }
+
+        HashCommand(panel.hash, command);
+        panel.region = Union(panel.region, bounds);
+    }
+
+    if (count != panel.first)
+    {
+        panel.count = count - panel.first;
+        _panels.push_back(panel);
+    }
+}
+
+void GuiCache::ClearRegion(const glm::ivec4& region)
+{
+    if (0 >= region.z)
+    {
+        return;
+    }
+
+    const auto x0 = static_cast<GLint>(std::floor(static_cast<float>(region.x - FringeMargin) * _pixelScale));
+    const auto y0 = static_cast<GLint>(std::floor(static_cast<float>(region.y - FringeMargin) * _pixelScale));
+    const auto x1 = static_cast<GLint>(std::ceil(static_cast<float>(region.x + region.z + FringeMargin) * _pixelScale));
+    const auto y1 = static_cast<GLint>(std::ceil(static_cast<float>(region.y + region.w + FringeMargin) * _pixelScale));
+
+    ::glEnable(GL_SCISSOR_TEST);
+    ::glScissor(x0, y0, x1 - x0, y1 - y0);
+    ::glClear(GL_COLOR_BUFFER_BIT);
+    ::glDisable(GL_SCISSOR_TEST);
+}
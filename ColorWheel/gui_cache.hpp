@@ -0,0 +1,77 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef GUI_CACHE
+#define GUI_CACHE
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "gl_texture.hpp"
+#include "gl_framebuffer.hpp"
+#include "gl_vertex_array.hpp"
+#include "gl_shader.hpp"
+#include "gl_program.hpp"
+
+struct imguiGfxCmd;
+
+
+// Render-to-texture cache of the GUI.
+//
+// imgui rebuilds its whole command queue every frame, but it rarely draws anything different. The
+// queue is split into panels (each scroll area, starting at its background), and each panel's
+// commands are hashed. Only panels whose hash or region changed since the last frame, and any
+// panels they overlap, are cleared and re-rendered into an offscreen texture; the texture is then
+// composited over the window with a single quad.
+class GuiCache
+{
+public:
+    // Throws:  InvalidFramebufferOperation : the driver can't render to an RGBA8 texture.
+    //          std::runtime_error : the composite shader failed to compile or link.
+    //          std::bad_alloc
+    GuiCache(const glm::ivec2 drawableSize, const glm::ivec2 screenSize, const float pixelScale);
+    virtual ~GuiCache();
+
+    // Re-renders the panels of commands that changed, then composites the GUI over the current
+    // viewport with premultiplied alpha blending.
+    // Throws:  std::bad_alloc
+    void Draw(const imguiGfxCmd* const pCommands, const int count);
+
+    // Returns: how many panels the last Draw() re-rendered.
+    std::size_t PanelsRedrawn() const noexcept
+    {
+        return _panelsRedrawn;
+    }
+
+    // Not copyable.
+    GuiCache(const GuiCache&) = delete;
+    GuiCache& operator =(const GuiCache&) = delete;
+
+private:
+    struct Panel
+    {
+        int             first;      // Command index.
+        int             count;
+        std::uint64_t   hash;
+        glm::ivec4      region;     // x, y, width, height in GUI units; y up.
+        bool            isDirty;
+    };
+
+    void FindPanels(const imguiGfxCmd* const pCommands, const int count);
+    void ClearRegion(const glm::ivec4& region);
+
+    glm::ivec2 _screenSize;
+    float _pixelScale;
+    gl::Texture _colorTexture;
+    gl::Framebuffer _framebuffer;
+    std::unique_ptr<gl::Program> _pCompositeProgram;
+    GLint _textureLocation;
+    gl::VertexArray _emptyVertexArray; // Core profile draws require one, even without attributes.
+    std::vector<Panel> _panels;
+    std::vector<Panel> _previousPanels;
+    std::size_t _panelsRedrawn;
+};
+
+
+#endif
@@ -19,6 +19,7 @@
 // Source altered and distributed from https://github.com/AdrienHerubel/imgui
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -30,35 +31,90 @@
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static const unsigned TEXT_POOL_SIZE = 8000;
-static char g_textPool[TEXT_POOL_SIZE];
+// The command queue and its text are per-frame arenas: reset in imguiBeginFrame, but never freed,
+// so once they've grown to the largest frame, building the GUI doesn't allocate. Text lives in
+// chunks that never move, since commands point into them; the queue is one array, doubled as it
+// fills, since it's handed out whole.
+static const unsigned TEXT_CHUNK_SIZE = 8192;
+static const unsigned GFXCMD_QUEUE_INITIAL_SIZE = 1024;
+
+struct imguiTextChunk
+{
+        imguiTextChunk* next;
+        unsigned capacity;
+        unsigned used;
+        // Followed by capacity bytes of text.
+};
+
+static imguiTextChunk* g_textChunks = 0;
+static imguiTextChunk* g_textChunk = 0;         // The chunk being filled.
 static unsigned g_textPoolSize = 0;
+static unsigned g_textPoolHighWater = 0;
 static const char* allocText(const char* text)
 {
-        unsigned long len = strlen(text)+1;
-        if (g_textPoolSize + len >= TEXT_POOL_SIZE)
-                return 0;
-        char* dst = &g_textPool[g_textPoolSize]; 
+        unsigned len = (unsigned)strlen(text)+1;
+        while (g_textChunk && g_textChunk->used + len > g_textChunk->capacity && g_textChunk->next)
+                g_textChunk = g_textChunk->next;
+        if (!g_textChunk || g_textChunk->used + len > g_textChunk->capacity)
+        {
+                unsigned capacity = len > TEXT_CHUNK_SIZE ? len : TEXT_CHUNK_SIZE;
+                imguiTextChunk* chunk = (imguiTextChunk*)malloc(sizeof(imguiTextChunk) + capacity);
+                if (!chunk)
+                        return 0;
+                chunk->next = 0;
+                chunk->capacity = capacity;
+                chunk->used = 0;
+                if (g_textChunk)
+                        g_textChunk->next = chunk;
+                else
+                        g_textChunks = chunk;
+                g_textChunk = chunk;
+        }
+        char* dst = (char*)(g_textChunk + 1) + g_textChunk->used;
         memcpy(dst, text, len);
+        g_textChunk->used += len;
         g_textPoolSize += len;
+        if (g_textPoolSize > g_textPoolHighWater)
+                g_textPoolHighWater = g_textPoolSize;
         return dst;
 }
 
-static const unsigned GFXCMD_QUEUE_SIZE = 5000;
-static imguiGfxCmd g_gfxCmdQueue[GFXCMD_QUEUE_SIZE];
+static imguiGfxCmd* g_gfxCmdQueue = 0;
+static unsigned g_gfxCmdQueueCapacity = 0;
 static unsigned g_gfxCmdQueueSize = 0;
+static unsigned g_gfxCmdQueueHighWater = 0;
+
+static imguiGfxCmd* allocGfxCmd()
+{
+        if (g_gfxCmdQueueSize >= g_gfxCmdQueueCapacity)
+        {
+                unsigned capacity = g_gfxCmdQueueCapacity ? g_gfxCmdQueueCapacity*2 : GFXCMD_QUEUE_INITIAL_SIZE;
+                imguiGfxCmd* queue = (imguiGfxCmd*)realloc(g_gfxCmdQueue, capacity*sizeof(imguiGfxCmd));
+                if (!queue)
+                        return 0;
+                g_gfxCmdQueue = queue;
+                g_gfxCmdQueueCapacity = capacity;
+        }
+        if (g_gfxCmdQueueSize >= g_gfxCmdQueueHighWater)
+                g_gfxCmdQueueHighWater = g_gfxCmdQueueSize+1;
+        return &g_gfxCmdQueue[g_gfxCmdQueueSize++];
+}
 
 static void resetGfxCmdQueue()
 {
         g_gfxCmdQueueSize = 0;
         g_textPoolSize = 0;
+        for (imguiTextChunk* chunk = g_textChunks; chunk; chunk = chunk->next)
+                chunk->used = 0;
+        g_textChunk = g_textChunks;
 }
 
 static void addGfxCmdScissor(int x, int y, int w, int h)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_SCISSOR;
         cmd.flags = x < 0 ? 0 : 1;      // on/off flag.
         cmd.col = 0;
@@ -70,9 +126,10 @@ static void addGfxCmdScissor(int x, int y, int w, int h)
 
 static void addGfxCmdRect(float x, float y, float w, float h, unsigned int color)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_RECT;
         cmd.flags = 0;
         cmd.col = color;
@@ -85,9 +142,10 @@ static void addGfxCmdRect(float x, float y, float w, float h, unsigned int color
 
 static void addGfxCmdLine(float x0, float y0, float x1, float y1, float r, unsigned int color)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_LINE;
         cmd.flags = 0;
         cmd.col = color;
@@ -100,9 +158,10 @@ static void addGfxCmdLine(float x0, float y0, float x1, float y1, float r, unsig
 
 static void addGfxCmdRoundedRect(float x, float y, float w, float h, float r, unsigned int color)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_RECT;
         cmd.flags = 0;
         cmd.col = color;
@@ -115,9 +174,10 @@ static void addGfxCmdRoundedRect(float x, float y, float w, float h, float r, un
 
 static void addGfxCmdTriangle(int x, int y, int w, int h, int flags, unsigned int color)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_TRIANGLE;
         cmd.flags = (char)flags;
         cmd.col = color;
@@ -129,9 +189,10 @@ static void addGfxCmdTriangle(int x, int y, int w, int h, int flags, unsigned in
 
 static void addGfxCmdText(int x, int y, int align, const char* text, unsigned int color)
 {
-        if (g_gfxCmdQueueSize >= GFXCMD_QUEUE_SIZE)
+        imguiGfxCmd* pcmd = allocGfxCmd();
+        if (!pcmd)
                 return;
-        imguiGfxCmd& cmd = g_gfxCmdQueue[g_gfxCmdQueueSize++];
+        imguiGfxCmd& cmd = *pcmd;
         cmd.type = IMGUI_GFXCMD_TEXT;
         cmd.flags = 0;
         cmd.col = color;
@@ -301,6 +362,12 @@ int imguiGetRenderQueueSize()
         return g_gfxCmdQueueSize;
 }
 
+void imguiGetRenderQueueHighWater(int* commands, int* textBytes)
+{
+        *commands = (int)g_gfxCmdQueueHighWater;
+        *textBytes = (int)g_textPoolHighWater;
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static const int BUTTON_HEIGHT = 20;
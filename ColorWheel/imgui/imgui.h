@@ -106,6 +106,8 @@ struct imguiGfxCmd
 
 const imguiGfxCmd* imguiGetRenderQueue();
 int imguiGetRenderQueueSize();
+// The most commands, and bytes of text, queued in any one frame so far.
+void imguiGetRenderQueueHighWater(int* commands, int* textBytes);
 
 
 #endif // IMGUI_H
\ No newline at end of file
@@ -22,6 +22,12 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 //#include "glew/glew.h"
 #ifdef __APPLE__
@@ -31,6 +37,9 @@
 #endif
 
 #include "imgui.h"
+#include "imguiRenderGL3.h"
+#include "../gl_state_cache.hpp"
+#include "../gl_texture.hpp"
 
 // Some math headers don't have PI defined.
 static const float PI = 3.14159265f;
@@ -56,31 +65,187 @@ void* imguimalloc(size_t size, void* /*userptr*/)
 static const unsigned TEMP_COORD_COUNT = 100;
 static float g_tempCoords[TEMP_COORD_COUNT*2];
 static float g_tempNormals[TEMP_COORD_COUNT*2];
-static float g_tempVertices[TEMP_COORD_COUNT * 12 + (TEMP_COORD_COUNT - 2) * 6];
-static float g_tempTextureCoords[TEMP_COORD_COUNT * 12 + (TEMP_COORD_COUNT - 2) * 6];
-static float g_tempColors[TEMP_COORD_COUNT * 24 + (TEMP_COORD_COUNT - 2) * 12];
+static GLuint g_tempIndices[TEMP_COORD_COUNT*9];
+static const unsigned QUAD_INDEX_COUNT = 4*9-6;
+static GLuint g_quadIndices[QUAD_INDEX_COUNT];
 
 static const int CIRCLE_VERTS = 8*4;
 static float g_circleVerts[CIRCLE_VERTS*2];
 
-static stbtt_bakedchar g_cdata[96]; // ASCII 32..126 is 95 glyphs
-static GLuint g_ftex = 0;
-static GLuint g_whitetex = 0;
+// The font atlas; its bottom right 2x2 texels are white, so shapes sample it too and every
+// primitive can share one texture (and one draw). Glyphs are rasterized into it as they're first
+// drawn, at the drawable's pixel size, and packed on shelves: rows of slots of one height.
+static const int FONT_ATLAS_SIZE = 512;
+static const int FONT_ATLAS_PADDING = 1;
+static const int FONT_ATLAS_RESERVED_ROWS = 4;  // Keeps the shelves clear of the white corner.
+static const unsigned short WHITE_TEXEL_UV = (unsigned short)(65535u * (FONT_ATLAS_SIZE - 1) / FONT_ATLAS_SIZE);
+static const float FONT_SIZE = 15.0f;           // In GUI units (points).
+
+struct imguiGlyph
+{
+        int x, y;               // The bitmap's atlas position.
+        int w, h;
+        int xoff, yoff;         // The bitmap's offset from the pen, y down, in pixels.
+        float xadvance;         // In pixels.
+        int slotW;              // The atlas slot holding the bitmap, padding included.
+        int shelf;              // -1, if the glyph has no bitmap (e.g. a space).
+        unsigned lastUsedFrame;
+};
+
+struct imguiShelf
+{
+        int y;
+        int height;
+        int x;                  // Where the next slot goes.
+};
+
+// tools/font_bake prerasterizes printable ASCII at the 1x and 2x pixel sizes, packed as the
+// allocator below would have, so startup only unpacks them into the atlas. The TTF is read the
+// first time a glyph isn't there (another size or character), or if it isn't the baked font.
+struct imguiBakedGlyph
+{
+        unsigned codepoint;
+        int pixelSize;
+        int x, y;
+        int w, h;
+        int xoff, yoff;
+        float xadvance;
+        int slotW;
+        int shelf;
+};
+
+#include "imguiBakedFont.inc"
+
+static stbtt_fontinfo g_font;
+static unsigned char* g_ttfBuffer = 0;  // stbtt_fontinfo reads the font from it.
+static std::string g_fontPath;
+static bool g_isFontMissing = false;    // Loading it failed; don't retry every glyph.
+static std::unique_ptr<gl::Texture> g_fontTexture;
+static std::unordered_map<unsigned, imguiGlyph> g_glyphs;      // By codepoint << 8 | pixel size.
+static std::vector<imguiShelf> g_shelves;
+static int g_shelfBottom = 0;
+static std::vector<unsigned char> g_glyphScratch;
+static unsigned g_atlasGeneration = 0;  // Incremented whenever a glyph is evicted.
+static float g_pixelScale = 1.0f;       // Drawable pixels per GUI unit.
+
+// In SDF mode, the atlas holds each glyph once, as a signed distance field rasterized at
+// SDF_PIXEL_SIZE, and the fragment shader draws it at any size from the one field.
+static const int SDF_PIXEL_SIZE = 32;
+static const int SDF_SPREAD = 4;        // Pixels, at SDF_PIXEL_SIZE, from the outline to 0 or 1.
+static const int SDF_CURVE_STEPS = 6;   // Line segments per quadratic curve.
+static bool g_isSdfText = false;
+static std::vector<float> g_sdfSegments;        // x0, y0, x1, y1 of each, in pixels (y down).
 static GLuint g_vao = 0;
-static GLuint g_vbos[3] = {0, 0, 0};
+static GLuint g_vbos[2] = {0, 0};   // Vertices, indices.
 static GLuint g_program = 0;
 static GLuint g_programViewportLocation = 0;
 static GLuint g_programTextureLocation = 0;
 
+// Every primitive of a frame is appended to one vertex and index stream, which is uploaded once.
+// 16 bytes: UVs are normalized 16-bit (1/128th of an atlas texel), colors normalized RGBA8.
+struct imguiVertex
+{
+        float x, y;
+        unsigned short u, v;
+        unsigned int col;   // RGBA8, as in imguiRGBA().
+};
+
+// A run of indices drawn with the same scissor state.
+struct imguiBatch
+{
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        bool isScissored;
+        int scissor[4];
+};
+
+static std::vector<imguiVertex> g_vertices;
+static std::vector<GLuint> g_indices;
+static std::vector<imguiBatch> g_batches;
+
+static gl::StateCache& stateCache()
+{
+        return gl::StateCache::Instance();
+}
+
 inline unsigned int RGBA(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
 {
         return (r) | (g << 8) | (b << 16) | (a << 24);
 }
 
-static void drawPolygon(const float* coords, unsigned numCoords, float r, unsigned int col)
+static void addVertex(float x, float y, unsigned short u, unsigned short v, unsigned int col)
+{
+        const imguiVertex vertex = { x, y, u, v, col };
+        g_vertices.push_back(vertex);
+}
+
+// Converts a texture coordinate in [0, 1] to normalized 16-bit.
+static unsigned short toUnorm16(float t)
+{
+        if (t <= 0.0f) return 0;
+        if (t >= 1.0f) return 65535;
+        return (unsigned short)(t * 65535.0f + 0.5f);
+}
+
+static void addTriangle(GLuint i0, GLuint i1, GLuint i2)
+{
+        g_indices.push_back(i0);
+        g_indices.push_back(i1);
+        g_indices.push_back(i2);
+}
+
+// Starts a new batch, unless the current one is empty (its scissor state is just replaced).
+static void beginBatch(bool isScissored, int x, int y, int w, int h)
+{
+        if (g_batches.empty() || g_batches.back().indexCount != 0)
+        {
+                imguiBatch batch;
+                batch.firstIndex = (unsigned int)g_indices.size();
+                batch.indexCount = 0;
+                g_batches.push_back(batch);
+        }
+        imguiBatch& batch = g_batches.back();
+        batch.isScissored = isScissored;
+        batch.scissor[0] = x;
+        batch.scissor[1] = y;
+        batch.scissor[2] = w;
+        batch.scissor[3] = h;
+}
+
+static void endPrimitive()
+{
+        imguiBatch& batch = g_batches.back();
+        batch.indexCount = (unsigned int)g_indices.size() - batch.firstIndex;
+}
+
+// Shapes are drawn as an opaque polygon, plus an anti-aliasing fringe r wide that fades to
+// transparent. Vertices [0, n) are the polygon and [n, 2n) the outside of its fringe; this
+// returns the triangles of the fringe and a fan over the polygon, relative to its first vertex.
+static unsigned makeShapeIndices(unsigned numCoords, GLuint* indices)
+{
+        GLuint* index = indices;
+        for (unsigned i = 0, j = numCoords-1; i < numCoords; j=i++)
+        {
+                *index++ = i;
+                *index++ = j;
+                *index++ = numCoords+j;
+                *index++ = numCoords+j;
+                *index++ = numCoords+i;
+                *index++ = i;
+        }
+        for (unsigned i = 2; i < numCoords; ++i)
+        {
+                *index++ = 0;
+                *index++ = i-1;
+                *index++ = i;
+        }
+        return (unsigned)(index - indices);
+}
+
+// Finds the direction each vertex of a convex polygon is pushed out to make a fringe 1 wide;
+// the average of its edges' normals, mitered.
+static void makeFringeDirections(const float* coords, unsigned numCoords, float* directions)
 {
-        if (numCoords > TEMP_COORD_COUNT) numCoords = TEMP_COORD_COUNT;
-        
         for (unsigned i = 0, j = numCoords-1; i < numCoords; j=i++)
         {
                 const float* v0 = &coords[j*2];
@@ -98,9 +263,6 @@ static void drawPolygon(const float* coords, unsigned numCoords, float r, unsign
                 g_tempNormals[j*2+1] = -dx;
         }
         
-        float colf[4] = { (float) (col&0xff) / 255.f, (float) ((col>>8)&0xff) / 255.f, (float) ((col>>16)&0xff) / 255.f, (float) ((col>>24)&0xff) / 255.f};
-        float colTransf[4] = { (float) (col&0xff) / 255.f, (float) ((col>>8)&0xff) / 255.f, (float) ((col>>16)&0xff) / 255.f, 0};
-
         for (unsigned i = 0, j = numCoords-1; i < numCoords; j=i++)
         {
                 float dlx0 = g_tempNormals[j*2+0];
@@ -117,117 +279,138 @@ static void drawPolygon(const float* coords, unsigned numCoords, float r, unsign
                         dmx *= scale;
                         dmy *= scale;
                 }
-                g_tempCoords[i*2+0] = coords[i*2+0]+dmx*r;
-                g_tempCoords[i*2+1] = coords[i*2+1]+dmy*r;
+                directions[i*2+0] = dmx;
+                directions[i*2+1] = dmy;
         }
-        
-        int vSize = numCoords * 12 + (numCoords - 2) * 6;
-        int uvSize = numCoords * 2 * 6 + (numCoords - 2) * 2 * 3;
-        int cSize = numCoords * 4 * 6 + (numCoords - 2) * 4 * 3;
-        float * v = g_tempVertices;
-        float * uv = g_tempTextureCoords;
-        memset(uv, 0, uvSize * sizeof(float));
-        float * c = g_tempColors;
-        memset(c, 1, cSize * sizeof(float));
-
-        float * ptrV = v;
-        float * ptrC = c;
-        for (unsigned i = 0, j = numCoords-1; i < numCoords; j=i++)
+}
+
+static void addShape(const float* coords, const float* directions, unsigned numCoords, float r,
+                     const GLuint* indices, unsigned numIndices, unsigned int col)
+{
+        const unsigned int colTrans = col & 0x00ffffff;
+
+        const GLuint base = (GLuint)g_vertices.size();
+        for (unsigned i = 0; i < numCoords; ++i)
         {
-            *ptrV = coords[i*2];
-            *(ptrV+1) = coords[i*2 + 1];
-            ptrV += 2;
-            *ptrV = coords[j*2];
-            *(ptrV+1) = coords[j*2 + 1];
-            ptrV += 2;          
-            *ptrV = g_tempCoords[j*2];
-            *(ptrV+1) = g_tempCoords[j*2 + 1];
-            ptrV += 2;                     
-            *ptrV = g_tempCoords[j*2];
-            *(ptrV+1) = g_tempCoords[j*2 + 1];
-            ptrV += 2;                     
-            *ptrV = g_tempCoords[i*2];
-            *(ptrV+1) = g_tempCoords[i*2 + 1];
-            ptrV += 2;                     
-            *ptrV = coords[i*2];
-            *(ptrV+1) = coords[i*2 + 1];            
-            ptrV += 2;
-
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;
-            *ptrC = colTransf[0];
-            *(ptrC+1) = colTransf[1];
-            *(ptrC+2) = colTransf[2];
-            *(ptrC+3) = colTransf[3];
-            ptrC += 4;
-            *ptrC = colTransf[0];
-            *(ptrC+1) = colTransf[1];
-            *(ptrC+2) = colTransf[2];
-            *(ptrC+3) = colTransf[3];
-            ptrC += 4;
-            *ptrC = colTransf[0];
-            *(ptrC+1) = colTransf[1];
-            *(ptrC+2) = colTransf[2];
-            *(ptrC+3) = colTransf[3];
-            ptrC += 4;
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;
+                addVertex(coords[i*2], coords[i*2+1], WHITE_TEXEL_UV, WHITE_TEXEL_UV, col);
         }
-        
-        for (unsigned i = 2; i < numCoords; ++i)
+        for (unsigned i = 0; i < numCoords; ++i)
         {
-            *ptrV = coords[0];
-            *(ptrV+1) = coords[1];
-            ptrV += 2;
-            *ptrV = coords[(i-1)*2];
-            *(ptrV+1) = coords[(i-1)*2+1];
-            ptrV += 2;  
-            *ptrV = coords[i*2];
-            *(ptrV+1) = coords[i*2 + 1];            
-            ptrV += 2;            
-
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;
-            *ptrC = colf[0];
-            *(ptrC+1) = colf[1];
-            *(ptrC+2) = colf[2];
-            *(ptrC+3) = colf[3];
-            ptrC += 4;          
-        }        
-        glBindTexture(GL_TEXTURE_2D, g_whitetex);
-        
-        glBindVertexArray(g_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[0]);
-        glBufferData(GL_ARRAY_BUFFER, vSize*sizeof(float), v, GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[1]);
-        glBufferData(GL_ARRAY_BUFFER, uvSize*sizeof(float), uv, GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[2]);
-        glBufferData(GL_ARRAY_BUFFER, cSize*sizeof(float), c, GL_STATIC_DRAW);
-        glDrawArrays(GL_TRIANGLES, 0, (numCoords * 2 + numCoords - 2)*3);
- 
+                addVertex(coords[i*2]+directions[i*2]*r, coords[i*2+1]+directions[i*2+1]*r,
+                          WHITE_TEXEL_UV, WHITE_TEXEL_UV, colTrans);
+        }
+
+        for (unsigned i = 0; i < numIndices; ++i)
+        {
+                g_indices.push_back(base+indices[i]);
+        }
+        endPrimitive();
+}
+
+// Fills a convex polygon, with an anti-aliasing fringe r wide.
+static void drawPolygon(const float* coords, unsigned numCoords, float r, unsigned int col)
+{
+        if (numCoords > TEMP_COORD_COUNT) numCoords = TEMP_COORD_COUNT;
+
+        makeFringeDirections(coords, numCoords, g_tempCoords);
+        const unsigned numIndices = makeShapeIndices(numCoords, g_tempIndices);
+        addShape(coords, g_tempCoords, numCoords, r, g_tempIndices, numIndices, col);
+}
+
+// Rectangles, rounded or not, are drawn from a template per corner radius: each corner's
+// outline, relative to the center of its arc, and the fringe directions are computed once.
+// Drawing one only moves the corners, and scales the fringe.
+static const unsigned SHAPE_TEMPLATE_MAX = 64;
+static const unsigned SHAPE_MAX_COORDS = (CIRCLE_VERTS/4+1)*4;
+
+struct imguiShapeTemplate
+{
+        unsigned coordsPerCorner;
+        float offsets[SHAPE_MAX_COORDS*2];
+        float directions[SHAPE_MAX_COORDS*2];
+        GLuint indices[SHAPE_MAX_COORDS*9];
+        unsigned numIndices;
+};
+
+static std::unordered_map<int, imguiShapeTemplate> g_shapeTemplates;   // By radius, in 1/8 units.
+
+static const imguiShapeTemplate* findShapeTemplate(int radius)
+{
+        const std::unordered_map<int, imguiShapeTemplate>::const_iterator found = g_shapeTemplates.find(radius);
+        if (found != g_shapeTemplates.end())
+        {
+                return &found->second;
+        }
+        if (g_shapeTemplates.size() >= SHAPE_TEMPLATE_MAX)
+        {
+                return 0;
+        }
+
+        imguiShapeTemplate& shape = g_shapeTemplates[radius];
+        const float r = (float)radius/8.0f;
+        const unsigned n = CIRCLE_VERTS/4;
+        shape.coordsPerCorner = radius ? n+1 : 1;
+
+        // Corners go counter-clockwise from the top right (y up), each a quarter of the circle.
+        float* offset = shape.offsets;
+        for (unsigned corner = 0; corner < 4; ++corner)
+        {
+                for (unsigned i = 0; i < shape.coordsPerCorner; ++i)
+                {
+                        const unsigned k = (corner*n + i) % CIRCLE_VERTS;
+                        *offset++ = g_circleVerts[k*2]*r;
+                        *offset++ = g_circleVerts[k*2+1]*r;
+                }
+        }
+
+        // The fringe doesn't depend on the size, as long as the straight edges aren't empty.
+        const unsigned numCoords = shape.coordsPerCorner*4;
+        const float corners[4*2] = { 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f };
+        float coords[SHAPE_MAX_COORDS*2];
+        for (unsigned i = 0; i < numCoords; ++i)
+        {
+                const unsigned corner = i/shape.coordsPerCorner;
+                coords[i*2+0] = corners[corner*2+0] + shape.offsets[i*2+0];
+                coords[i*2+1] = corners[corner*2+1] + shape.offsets[i*2+1];
+        }
+        makeFringeDirections(coords, numCoords, shape.directions);
+        shape.numIndices = makeShapeIndices(numCoords, shape.indices);
+        return &shape;
+}
+
+// Returns false if the rectangle is too small for its radius, or the templates are full.
+static bool drawShapeTemplate(float x, float y, float w, float h, int radius, float fth, unsigned int col)
+{
+        const float r = (float)radius/8.0f;
+        if (w <= r*2 || h <= r*2)
+        {
+                return false;
+        }
+        const imguiShapeTemplate* shape = findShapeTemplate(radius);
+        if (!shape)
+        {
+                return false;
+        }
+
+        const float corners[4*2] = { x+w-r, y+h-r, x+r, y+h-r, x+r, y+r, x+w-r, y+r };
+        const unsigned numCoords = shape->coordsPerCorner*4;
+        for (unsigned i = 0; i < numCoords; ++i)
+        {
+                const unsigned corner = i/shape->coordsPerCorner;
+                g_tempCoords[i*2+0] = corners[corner*2+0] + shape->offsets[i*2+0];
+                g_tempCoords[i*2+1] = corners[corner*2+1] + shape->offsets[i*2+1];
+        }
+        addShape(g_tempCoords, shape->directions, numCoords, fth, shape->indices, shape->numIndices, col);
+        return true;
 }
 
 static void drawRect(float x, float y, float w, float h, float fth, unsigned int col)
 {
+        if (drawShapeTemplate(x+0.5f, y+0.5f, w-1.0f, h-1.0f, 0, fth, col))
+        {
+                return;
+        }
+
         float verts[4*2] =
         {
                 x+0.5f, y+0.5f,
@@ -255,8 +438,15 @@ static void drawEllipse(float x, float y, float w, float h, float fth, unsigned
 }
 */
 
-static void drawRoundedRect(float x, float y, float w, float h, float r, float fth, unsigned int col)
+// The radius is in 1/8 units, as queued.
+static void drawRoundedRect(float x, float y, float w, float h, int radius, float fth, unsigned int col)
 {
+        if (drawShapeTemplate(x, y, w, h, radius, fth, col))
+        {
+                return;
+        }
+
+        const float r = (float)radius/8.0f;
         const unsigned n = CIRCLE_VERTS/4;
         float verts[(n+1)*4*2];
         const float* cverts = g_circleVerts;
@@ -305,6 +495,18 @@ static void drawLine(float x0, float y0, float x1, float y1, float r, float fth,
         }
         float nx = dy;
         float ny = -dx;
+
+        // The quad's edges run along the line and its normal, so each corner's fringe goes out
+        // diagonally; no need to find them from its edges. (Unless it's too short to have a
+        // direction, in which case neither does its fringe.)
+        const float directions[4*2] =
+        {
+                -dx-nx, -dy-ny,
+                -dx+nx, -dy+ny,
+                dx+nx, dy+ny,
+                dx-nx, dy-ny,
+        };
+
         float verts[4*2];
         r -= fth;
         r *= 0.5f;
@@ -326,78 +528,260 @@ static void drawLine(float x0, float y0, float x1, float y1, float r, float fth,
         verts[6] = x1+dx-nx;
         verts[7] = y1+dy-ny;
         
-        drawPolygon(verts, 4, fth, col);
+        if (d > 0.0001f)
+        {
+                addShape(verts, directions, 4, fth, g_quadIndices, QUAD_INDEX_COUNT, col);
+        }
+        else
+        {
+                drawPolygon(verts, 4, fth, col);
+        }
 }
 
+// Labels are laid out once, relative to their origin, and kept while they're drawn. Glyph quads
+// land on whole pixels, so moving a run by a whole-pixel origin gives the same quads as laying it
+// out again. Runs are laid out again once the atlas evicts any glyph. The table is fixed; a label that finds no free slot in its probe window replaces the
+// one that was drawn longest ago, and longer labels are laid out every time.
+static const unsigned GLYPH_RUN_SLOTS = 128;    // Power of two.
+static const unsigned GLYPH_RUN_PROBES = 8;
+static const unsigned GLYPH_RUN_MAX_CHARS = 64;
 
-bool imguiRenderGLInit(const char* fontpath)
+struct imguiGlyphRun
 {
-        for (int i = 0; i < CIRCLE_VERTS; ++i)
+        unsigned long long hash;        // 0, if the slot is empty.
+        unsigned lastUsedFrame;
+        unsigned atlasGeneration;       // The run is stale once any glyph has been evicted since.
+        int align;
+        unsigned vertexCount;
+        char text[GLYPH_RUN_MAX_CHARS+1];
+        imguiVertex vertices[GLYPH_RUN_MAX_CHARS*4];    // Relative to the origin; col is unset.
+        imguiGlyph* glyphs[GLYPH_RUN_MAX_CHARS];        // Marked used whenever the run is drawn.
+};
+
+static imguiGlyphRun g_glyphRuns[GLYPH_RUN_SLOTS];
+static unsigned g_frame = 0;
+
+static void clearGlyphRuns()
+{
+        for (unsigned i = 0; i < GLYPH_RUN_SLOTS; ++i)
         {
-                float a = (float)i/(float)CIRCLE_VERTS * PI*2;
-                g_circleVerts[i*2+0] = cosf(a);
-                g_circleVerts[i*2+1] = sinf(a);
+                g_glyphRuns[i].hash = 0;
+        }
+}
+
+// Takes ttf, from malloc().
+static bool initFont(unsigned char* ttf)
+{
+        if (!stbtt_InitFont(&g_font, ttf, stbtt_GetFontOffsetForIndex(ttf, 0)))
+        {
+                free(ttf);
+                return false;
         }
 
-        // Load font.
-        FILE* fp = fopen(fontpath, "rb");
+        g_ttfBuffer = ttf;
+        g_isFontMissing = false;
+        return true;
+}
+
+static bool loadFont()
+{
+        if (g_ttfBuffer) return true;
+        if (g_isFontMissing) return false;
+        g_isFontMissing = true;
+
+        FILE* fp = fopen(g_fontPath.c_str(), "rb");
         if (!fp) return false;
         fseek(fp, 0, SEEK_END);
         long size = ftell(fp);
         fseek(fp, 0, SEEK_SET);
         
-        unsigned char* ttfBuffer = (unsigned char*)malloc(size); 
-        if (!ttfBuffer)
+        unsigned char* ttf = (unsigned char*)malloc(size);
+        if (!ttf)
         {
                 fclose(fp);
                 return false;
         }
         
-        fread(ttfBuffer, 1, size, fp);
+        fread(ttf, 1, size, fp);
         fclose(fp);
         fp = 0;
+
+        return initFont(ttf);
+}
+
+// Returns: true, if fontpath names the file the atlas was baked from (by name and size). size is
+//          the file's, or -1 to look it up.
+static bool isBakedFont(const char* fontpath, long size)
+{
+        if (BAKED_FONT_ATLAS_SIZE != FONT_ATLAS_SIZE || BAKED_FONT_ATLAS_PADDING != FONT_ATLAS_PADDING)
+                return false;
+
+        const char* name = strrchr(fontpath, '/');
+        name = name ? name+1 : fontpath;
+        if (strcmp(name, BAKED_FONT_NAME) != 0)
+                return false;
+
+        if (size < 0)
+        {
+                FILE* fp = fopen(fontpath, "rb");
+                if (!fp) return false;
+                fseek(fp, 0, SEEK_END);
+                size = ftell(fp);
+                fclose(fp);
+        }
+        return size == BAKED_FONT_FILE_SIZE;
+}
+
+// Decompresses PackBits: a header byte n below 128 is followed by n+1 literal bytes; above 128,
+// by one byte repeated 257-n times.
+static bool unpackBits(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize)
+{
+        const unsigned char* srcEnd = src + srcSize;
+        unsigned char* dstEnd = dst + dstSize;
+        while (src < srcEnd)
+        {
+                const unsigned n = *src++;
+                if (n < 128)
+                {
+                        if ((size_t)(srcEnd - src) < n+1 || (size_t)(dstEnd - dst) < n+1) return false;
+                        memcpy(dst, src, n+1);
+                        src += n+1;
+                        dst += n+1;
+                }
+                else if (n > 128)
+                {
+                        if (src == srcEnd || (size_t)(dstEnd - dst) < 257-n) return false;
+                        memset(dst, *src++, 257-n);
+                        dst += 257-n;
+                }
+        }
+        return dst == dstEnd;
+}
+
+
+bool imguiRenderGLInit(const char* fontpath, imguiTextMode textMode, const unsigned char* fontData, int fontDataSize)
+{
+        g_isSdfText = textMode == IMGUI_TEXT_SDF;
+
+        for (int i = 0; i < CIRCLE_VERTS; ++i)
+        {
+                float a = (float)i/(float)CIRCLE_VERTS * PI*2;
+                g_circleVerts[i*2+0] = cosf(a);
+                g_circleVerts[i*2+1] = sinf(a);
+        }
+        g_shapeTemplates.clear();
+        makeShapeIndices(4, g_quadIndices);
+
+        // Load font; or, if it's the one that was baked, put off reading it until it's needed.
+        free(g_ttfBuffer);
+        g_ttfBuffer = 0;
+        g_isFontMissing = false;
+        g_fontPath = fontpath;
+        const bool hasFontData = fontData && fontDataSize > 0;
+        bool isBaked = !g_isSdfText && isBakedFont(fontpath, hasFontData ? fontDataSize : -1);
+        if (hasFontData)
+        {
+                unsigned char* ttf = (unsigned char*)malloc(fontDataSize);
+                if (!ttf) return false;
+                memcpy(ttf, fontData, fontDataSize);
+                if (!initFont(ttf))
+                        return false;
+        }
+        else if (!isBaked && !loadFont())
+        {
+                return false;
+        }
         
-        unsigned char* bmap = (unsigned char*)malloc(512*512);
+        unsigned char* bmap = (unsigned char*)calloc(FONT_ATLAS_SIZE*FONT_ATLAS_SIZE, 1);
         if (!bmap)
         {
-                free(ttfBuffer);
+                free(g_ttfBuffer);
+                g_ttfBuffer = 0;
                 return false;
         }
+
+        if (isBaked && !unpackBits(BAKED_FONT_ROWS, sizeof(BAKED_FONT_ROWS), bmap, FONT_ATLAS_SIZE*BAKED_FONT_SHELF_BOTTOM))
+        {
+                memset(bmap, 0, FONT_ATLAS_SIZE*BAKED_FONT_SHELF_BOTTOM);
+                isBaked = false;
+                if (!loadFont())
+                {
+                        free(bmap);
+                        return false;
+                }
+        }
+
+        // The glyphs are packed from the top left; the white texels go in the opposite corner.
+        for (int y = FONT_ATLAS_SIZE - 2; y < FONT_ATLAS_SIZE; ++y)
+        {
+                for (int x = FONT_ATLAS_SIZE - 2; x < FONT_ATLAS_SIZE; ++x)
+                {
+                        bmap[y*FONT_ATLAS_SIZE + x] = 255;
+                }
+        }
         
-        stbtt_BakeFontBitmap(ttfBuffer,0, 15.0f, bmap,512,512, 32,96, g_cdata);
-        
-        // can free ttf_buffer at this point
-        glGenTextures(1, &g_ftex);
-        glBindTexture(GL_TEXTURE_2D, g_ftex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 512,512, 0, GL_RED, GL_UNSIGNED_BYTE, bmap);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // can free ttf_buffer at this point
-        unsigned char white_alpha = 255;
-        glGenTextures(1, &g_whitetex);
-        glBindTexture(GL_TEXTURE_2D, g_whitetex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 1, 1, 0, GL_RED, GL_UNSIGNED_BYTE, &white_alpha);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        try
+        {
+                g_fontTexture.reset(new gl::Texture);
+                g_fontTexture->Storage(gl::TextureFormat::R8, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE);
+                g_fontTexture->SubImage(0, 0, 0, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, GL_RED, GL_UNSIGNED_BYTE, bmap);
+                g_fontTexture->SetFilters(gl::TextureFilter::Linear, gl::TextureFilter::Linear);
+
+                g_glyphs.clear();
+                g_glyphs.reserve(512);
+                g_sdfSegments.reserve(4*1024);
+                g_shelves.clear();
+                g_shelves.reserve(FONT_ATLAS_SIZE / 4);
+                g_shelfBottom = FONT_ATLAS_PADDING;
+                if (isBaked)
+                {
+                        const size_t shelfCount = sizeof(BAKED_FONT_SHELVES)/sizeof(BAKED_FONT_SHELVES[0]);
+                        g_shelves.assign(BAKED_FONT_SHELVES, BAKED_FONT_SHELVES + shelfCount);
+                        g_shelfBottom = BAKED_FONT_SHELF_BOTTOM;
+                        for (size_t i = 0; i < sizeof(BAKED_FONT_GLYPHS)/sizeof(BAKED_FONT_GLYPHS[0]); ++i)
+                        {
+                                const imguiBakedGlyph& baked = BAKED_FONT_GLYPHS[i];
+                                const imguiGlyph glyph = { baked.x, baked.y, baked.w, baked.h, baked.xoff, baked.yoff,
+                                                           baked.xadvance, baked.slotW, baked.shelf, g_frame };
+                                g_glyphs[(baked.codepoint << 8) | (unsigned)baked.pixelSize] = glyph;
+                        }
+                }
+                g_glyphScratch.reserve(64*64);
+                ++g_atlasGeneration;
+                clearGlyphRuns();
+
+                // A panel full of text and shapes, without growing.
+                g_vertices.reserve(16384);
+                g_indices.reserve(32768);
+                g_batches.reserve(64);
+        }
+        catch (const std::exception&)
+        {
+                g_fontTexture.reset();
+                free(g_ttfBuffer);
+                g_ttfBuffer = 0;
+                free(bmap);
+                return false;
+        }
+        free(bmap);
 
         glGenVertexArrays(1, &g_vao);
-        glGenBuffers(3, g_vbos);
+        glGenBuffers(2, g_vbos);
 
-        glBindVertexArray(g_vao);
+        stateCache().BindVertexArray(g_vao);
         glEnableVertexAttribArray(0);
         glEnableVertexAttribArray(1);
         glEnableVertexAttribArray(2);
 
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[0]);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GL_FLOAT)*2, (void*)0);
-        glBufferData(GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[1]);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GL_FLOAT)*2, (void*)0);
-        glBufferData(GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[2]);
-        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GL_FLOAT)*4, (void*)0);
-        glBufferData(GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW);
+        stateCache().BindBuffer(GL_ARRAY_BUFFER, g_vbos[0]);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(imguiVertex), (void*)offsetof(imguiVertex, x));
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(imguiVertex), (void*)offsetof(imguiVertex, u));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(imguiVertex), (void*)offsetof(imguiVertex, col));
+        glBufferData(GL_ARRAY_BUFFER, 0, 0, GL_STREAM_DRAW);
+
+        // The element array binding is part of the vertex array's state.
+        stateCache().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_vbos[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, 0, GL_STREAM_DRAW);
         g_program = glCreateProgram();
     
         const char * vs =
@@ -430,8 +814,26 @@ bool imguiRenderGLInit(const char* fontpath)
         "    float alpha = texture(Texture, texCoord).r;\n"
         "    Color = vec4(vertexColor.rgb, vertexColor.a * alpha);\n"
         "}\n";
+
+        // Edges fall where the distance crosses 0.5, anti-aliased over about a pixel. Shapes sample
+        // the white texel, which is far inside.
+        const char * sdfFs =
+        "#version 150\n"
+        "in vec2 texCoord;\n"
+        "in vec4 vertexColor;\n"
+        "uniform sampler2D Texture;\n"
+        "out vec4  Color;\n"
+        "void main(void)\n"
+        "{\n"
+        "    float distance = texture(Texture, texCoord).r;\n"
+        "    float width = max(0.5 * fwidth(distance), 0.001);\n"
+        "    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);\n"
+        "    Color = vec4(vertexColor.rgb, vertexColor.a * alpha);\n"
+        "}\n";
         GLuint fso = glCreateShader(GL_FRAGMENT_SHADER);
 
+        if (g_isSdfText)
+                fs = sdfFs;
         glShaderSource(fso, 1, (const char **) &fs, NULL);
         glCompileShader(fso);
         glAttachShader(g_program, fso);
@@ -444,190 +846,544 @@ bool imguiRenderGLInit(const char* fontpath)
         glDeleteShader(vso);
         glDeleteShader(fso);
 
-        glUseProgram(g_program);
+        stateCache().UseProgram(g_program);
         g_programViewportLocation = glGetUniformLocation(g_program, "Viewport");
         g_programTextureLocation = glGetUniformLocation(g_program, "Texture");
 
-        glUseProgram(0);
-
-
-        free(ttfBuffer);
-        free(bmap);
+        stateCache().UseProgram(0);
 
         return true;
 }
 
 void imguiRenderGLDestroy()
 {
-        if (g_ftex)
-        {
-                glDeleteTextures(1, &g_ftex);
-                g_ftex = 0;
-        }
+        g_fontTexture.reset();
+        g_glyphs.clear();
+        g_shelves.clear();
+        free(g_ttfBuffer);
+        g_ttfBuffer = 0;
 
         if (g_vao)
         {
             glDeleteVertexArrays(1, &g_vao);
-            glDeleteBuffers(3, g_vbos);
+            glDeleteBuffers(2, g_vbos);
+            stateCache().VertexArrayDeleted(g_vao);
+            for (int i = 0; i < 2; ++i)
+                    stateCache().BufferDeleted(g_vbos[i]);
             g_vao = 0;
         }
 
         if (g_program)
         {
             glDeleteProgram(g_program);
+            stateCache().ProgramDeleted(g_program);
             g_program = 0;
         }
 
 }
 
-static void getBakedQuad(stbtt_bakedchar *chardata, int pw, int ph, int char_index,
-                                                 float *xpos, float *ypos, stbtt_aligned_quad *q)
+static int fontPixelSize()
 {
-        stbtt_bakedchar *b = chardata + char_index;
-        int round_x = STBTT_ifloor(*xpos + b->xoff);
-        int round_y = STBTT_ifloor(*ypos - b->yoff);
-        
-        q->x0 = (float)round_x;
-        q->y0 = (float)round_y;
-        q->x1 = (float)round_x + b->x1 - b->x0;
-        q->y1 = (float)round_y - b->y1 + b->y0;
-        
-        q->s0 = b->x0 / (float)pw;
-        q->t0 = b->y0 / (float)pw;
-        q->s1 = b->x1 / (float)ph;
-        q->t1 = b->y1 / (float)ph;
+        const int size = (int)(FONT_SIZE*g_pixelScale + 0.5f);
+        return size < 1 ? 1 : (size > 255 ? 255 : size);
+}
+
+// Returns: the pixel size glyphs are rasterized into the atlas at.
+static int glyphPixelSize()
+{
+        return g_isSdfText ? SDF_PIXEL_SIZE : fontPixelSize();
+}
+
+// Returns: drawn pixels per atlas pixel.
+static float glyphScale()
+{
+        return g_isSdfText ? (float)fontPixelSize() / (float)SDF_PIXEL_SIZE : 1.0f;
+}
+
+static void addSdfSegment(float x0, float y0, float x1, float y1)
+{
+        g_sdfSegments.push_back(x0);
+        g_sdfSegments.push_back(y0);
+        g_sdfSegments.push_back(x1);
+        g_sdfSegments.push_back(y1);
+}
+
+// Writes the signed distance field of glyph's outline into out: 0.5 on the outline, rising to 1
+// SDF_SPREAD pixels inside it, and falling to 0 as far outside.
+static void makeGlyphSdf(int glyphIndex, float scale, const imguiGlyph& glyph, unsigned char* out, int stride)
+{
+        // Flatten the outline into line segments.
+        stbtt_vertex* shape = 0;
+        const int vertexCount = stbtt_GetGlyphShape(&g_font, glyphIndex, &shape);
+        g_sdfSegments.clear();
+        float x = 0, y = 0;
+        for (int i = 0; i < vertexCount; ++i)
+        {
+                const stbtt_vertex& v = shape[i];
+                const float vx = v.x*scale;
+                const float vy = -v.y*scale;
+                if (v.type == STBTT_vline)
+                {
+                        addSdfSegment(x, y, vx, vy);
+                }
+                else if (v.type == STBTT_vcurve)
+                {
+                        const float cx = v.cx*scale;
+                        const float cy = -v.cy*scale;
+                        float lx = x, ly = y;
+                        for (int j = 1; j <= SDF_CURVE_STEPS; ++j)
+                        {
+                                const float t = (float)j / (float)SDF_CURVE_STEPS;
+                                const float u = 1.0f - t;
+                                const float qx = u*u*x + 2.0f*u*t*cx + t*t*vx;
+                                const float qy = u*u*y + 2.0f*u*t*cy + t*t*vy;
+                                addSdfSegment(lx, ly, qx, qy);
+                                lx = qx;
+                                ly = qy;
+                        }
+                }
+                x = vx;
+                y = vy;
+        }
+        stbtt_FreeShape(&g_font, shape);
+
+        const size_t segmentCount = g_sdfSegments.size() / 4;
+        const float* segments = segmentCount ? &g_sdfSegments[0] : 0;
+        for (int row = 0; row < glyph.h; ++row)
+        {
+                const float py = (float)(glyph.yoff + row) + 0.5f;
+                for (int column = 0; column < glyph.w; ++column)
+                {
+                        const float px = (float)(glyph.xoff + column) + 0.5f;
+                        float nearest = 1e30f;
+                        int winding = 0;
+                        for (size_t i = 0; i < segmentCount; ++i)
+                        {
+                                const float* seg = &segments[i*4];
+                                const float ex = seg[2] - seg[0];
+                                const float ey = seg[3] - seg[1];
+                                const float wx = px - seg[0];
+                                const float wy = py - seg[1];
+                                const float length2 = ex*ex + ey*ey;
+                                float t = length2 > 0.0f ? (wx*ex + wy*ey) / length2 : 0.0f;
+                                t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+                                const float dx = wx - ex*t;
+                                const float dy = wy - ey*t;
+                                const float distance2 = dx*dx + dy*dy;
+                                if (distance2 < nearest) nearest = distance2;
+
+                                // Non-zero winding rule, as TrueType fills outlines.
+                                const float side = ex*wy - wx*ey;
+                                if (seg[1] <= py)
+                                {
+                                        if (seg[3] > py && side > 0.0f) ++winding;
+                                }
+                                else if (seg[3] <= py && side < 0.0f)
+                                {
+                                        --winding;
+                                }
+                        }
+
+                        const float distance = winding ? sqrtf(nearest) : -sqrtf(nearest);
+                        float value = 0.5f + distance / (2.0f*SDF_SPREAD);
+                        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+                        out[row*stride + column] = (unsigned char)(value*255.0f + 0.5f);
+                }
+        }
+}
+
+// Finds an atlas slot for a w by h bitmap: on a shelf of its height, on a new shelf, or else in
+// place of the least recently drawn glyph that fits (never one drawn this frame).
+static bool allocateGlyphSlot(int w, int h, imguiGlyph* glyph)
+{
+        const int slotW = w + FONT_ATLAS_PADDING;
+        const int slotH = (h + FONT_ATLAS_PADDING + 3) & ~3;
         
-        *xpos += b->xadvance;
+        for (size_t i = 0; i < g_shelves.size(); ++i)
+        {
+                imguiShelf& shelf = g_shelves[i];
+                if (shelf.height == slotH && shelf.x + slotW <= FONT_ATLAS_SIZE)
+                {
+                        glyph->x = shelf.x;
+                        glyph->y = shelf.y;
+                        glyph->slotW = slotW;
+                        glyph->shelf = (int)i;
+                        shelf.x += slotW;
+                        return true;
+                }
+        }
+
+        if (g_shelfBottom + slotH <= FONT_ATLAS_SIZE - FONT_ATLAS_RESERVED_ROWS)
+        {
+                imguiShelf shelf = { g_shelfBottom, slotH, FONT_ATLAS_PADDING + slotW };
+                glyph->x = FONT_ATLAS_PADDING;
+                glyph->y = g_shelfBottom;
+                glyph->slotW = slotW;
+                glyph->shelf = (int)g_shelves.size();
+                g_shelves.push_back(shelf);
+                g_shelfBottom += slotH;
+                return true;
+        }
+
+        std::unordered_map<unsigned, imguiGlyph>::iterator victim = g_glyphs.end();
+        for (std::unordered_map<unsigned, imguiGlyph>::iterator it = g_glyphs.begin(); it != g_glyphs.end(); ++it)
+        {
+                const imguiGlyph& candidate = it->second;
+                if (candidate.shelf < 0 || candidate.lastUsedFrame == g_frame)
+                        continue;
+                const int height = g_shelves[candidate.shelf].height;
+                if (candidate.slotW < slotW || height < slotH || height > slotH*2)
+                        continue;
+                if (victim == g_glyphs.end() ||
+                    g_frame - candidate.lastUsedFrame > g_frame - victim->second.lastUsedFrame)
+                        victim = it;
+        }
+        if (victim == g_glyphs.end())
+        {
+                return false;
+        }
+
+        glyph->x = victim->second.x;
+        glyph->y = victim->second.y;
+        glyph->slotW = victim->second.slotW;
+        glyph->shelf = victim->second.shelf;
+        g_glyphs.erase(victim);
+        ++g_atlasGeneration;
+        return true;
+}
+
+// Returns: the glyph for codepoint at the current pixel size, rasterized into the atlas if it
+//          wasn't already; 0, if the atlas has no room for it this frame.
+static imguiGlyph* getGlyph(unsigned codepoint)
+{
+        const int pixelSize = glyphPixelSize();
+        const unsigned key = (codepoint << 8) | (unsigned)pixelSize;
+        std::unordered_map<unsigned, imguiGlyph>::iterator found = g_glyphs.find(key);
+        if (found != g_glyphs.end())
+        {
+                found->second.lastUsedFrame = g_frame;
+                return &found->second;
+        }
+
+        if (!loadFont())
+        {
+                return 0;
+        }
+
+        const float scale = stbtt_ScaleForPixelHeight(&g_font, (float)pixelSize);
+        int advance, lsb;
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointHMetrics(&g_font, (int)codepoint, &advance, &lsb);
+        stbtt_GetCodepointBitmapBox(&g_font, (int)codepoint, scale, scale, &x0, &y0, &x1, &y1);
+
+        imguiGlyph glyph;
+        glyph.x = 0;
+        glyph.y = 0;
+        glyph.w = x1 - x0;
+        glyph.h = y1 - y0;
+        glyph.xoff = x0;
+        glyph.yoff = y0;
+        glyph.xadvance = scale * (float)advance;
+        glyph.slotW = 0;
+        glyph.shelf = -1;
+        glyph.lastUsedFrame = g_frame;
+
+        // Distance fields reach SDF_SPREAD pixels past the outline.
+        const bool isSdf = g_isSdfText && glyph.w > 0 && glyph.h > 0;
+        if (isSdf)
+        {
+                glyph.w += 2*SDF_SPREAD;
+                glyph.h += 2*SDF_SPREAD;
+                glyph.xoff -= SDF_SPREAD;
+                glyph.yoff -= SDF_SPREAD;
+        }
+
+        if (glyph.w > 0 && glyph.h > 0)
+        {
+                if (!allocateGlyphSlot(glyph.w, glyph.h, &glyph))
+                {
+                        return 0;
+                }
+
+                // Upload the whole slot, so nothing of an evicted glyph is left around this one. Rows
+                // are padded to 4 bytes, the default unpack alignment.
+                const int slotW = glyph.slotW - FONT_ATLAS_PADDING;
+                const int slotH = g_shelves[glyph.shelf].height - FONT_ATLAS_PADDING;
+                const int stride = (slotW + 3) & ~3;
+                g_glyphScratch.assign((size_t)(stride*slotH), 0);
+                if (isSdf)
+                        makeGlyphSdf(stbtt_FindGlyphIndex(&g_font, (int)codepoint), scale, glyph, &g_glyphScratch[0], stride);
+                else
+                        stbtt_MakeCodepointBitmap(&g_font, &g_glyphScratch[0], glyph.w, glyph.h, stride, scale, scale, (int)codepoint);
+                try
+                {
+                        g_fontTexture->SubImage(0, glyph.x, glyph.y, slotW, slotH, GL_RED, GL_UNSIGNED_BYTE, &g_glyphScratch[0]);
+                }
+                catch (const std::exception&)
+                {
+                        glyph.w = 0;
+                        glyph.h = 0;
+                }
+        }
+
+        return &g_glyphs.insert(std::make_pair(key, glyph)).first->second;
+}
+
+// Decodes the UTF-8 sequence at text, and moves text past it; malformed input decodes as U+FFFD.
+static unsigned decodeUtf8(const char** text)
+{
+        const unsigned char* c = (const unsigned char*)*text;
+        unsigned codepoint;
+        int length;
+        if (c[0] < 0x80)                { codepoint = c[0];        length = 1; }
+        else if ((c[0] & 0xe0) == 0xc0) { codepoint = c[0] & 0x1f; length = 2; }
+        else if ((c[0] & 0xf0) == 0xe0) { codepoint = c[0] & 0x0f; length = 3; }
+        else if ((c[0] & 0xf8) == 0xf0) { codepoint = c[0] & 0x07; length = 4; }
+        else
+        {
+                *text += 1;
+                return 0xfffd;
+        }
+
+        for (int i = 1; i < length; ++i)
+        {
+                if ((c[i] & 0xc0) != 0x80)
+                {
+                        *text += i;
+                        return 0xfffd;
+                }
+                codepoint = (codepoint << 6) | (c[i] & 0x3f);
+        }
+        *text += length;
+        return codepoint > 0x10ffff ? 0xfffd : codepoint;
 }
 
 static const float g_tabStops[4] = {150, 210, 270, 330};
 
-static float getTextLength(stbtt_bakedchar *chardata, const char* text)
+// Returns: the width of text, in pixels.
+static float getTextLength(const char* text)
 {
+        const float k = glyphScale();
         float xpos = 0;
         float len = 0;
         while (*text)
         {
-                int c = (unsigned char)*text;
+                const unsigned c = decodeUtf8(&text);
                 if (c == '\t')
                 {
                         for (int i = 0; i < 4; ++i)
                         {
-                                if (xpos < g_tabStops[i])
+                                if (xpos < g_tabStops[i]*g_pixelScale)
                                 {
-                                        xpos = g_tabStops[i];
+                                        xpos = g_tabStops[i]*g_pixelScale;
                                         break;
                                 }
                         }
                 }
-                else if (c >= 32 && c < 128)
+                else if (c >= 32)
                 {
-                        stbtt_bakedchar *b = chardata + c-32;
-                        int round_x = STBTT_ifloor((xpos + b->xoff) + 0.5);
-                        len = round_x + b->x1 - b->x0 + 0.5f;
-                        xpos += b->xadvance;
+                        const imguiGlyph* g = getGlyph(c);
+                        if (!g) continue;
+                        const float gx = xpos + g->xoff*k;
+                        len = (g_isSdfText ? gx : (float)STBTT_ifloor(gx + 0.5f)) + g->w*k + 0.5f;
+                        xpos += g->xadvance*k;
                 }
-                ++text;
         }
         return len;
 }
 
-static void drawText(float x, float y, const char *text, int align, unsigned int col)
+// Appends the quads of text, aligned at (x, y), to the vertex stream; returns how many vertices.
+// Each glyph with a quad is also put in glyphs, if it isn't null.
+static unsigned layoutText(float x, float y, const char *text, int align, unsigned int col, imguiGlyph** glyphs)
 {
-        if (!g_ftex) return;
-        if (!text) return;
-        
+        // Laid out in pixels, so glyphs land on the drawable's pixel grid.
+        float px = x*g_pixelScale;
+        float py = y*g_pixelScale;
         if (align == IMGUI_ALIGN_CENTER)
-                x -= getTextLength(g_cdata, text)/2;
+                px -= getTextLength(text)/2;
         else if (align == IMGUI_ALIGN_RIGHT)
-                x -= getTextLength(g_cdata, text);
-        
-        float r = (float) (col&0xff) / 255.f;
-        float g = (float) ((col>>8)&0xff) / 255.f;
-        float b = (float) ((col>>16)&0xff) / 255.f;
-        float a = (float) ((col>>24)&0xff) / 255.f;
+                px -= getTextLength(text);
 
         // assume orthographic projection with units = screen pixels, origin at top left
-        glBindTexture(GL_TEXTURE_2D, g_ftex);
-        
-        const float ox = x;
+        const float ox = px;
+        const float toUnits = 1.0f/g_pixelScale;
+        const float k = glyphScale();
+        const float toUv = 1.0f/(float)FONT_ATLAS_SIZE;
+        const size_t first = g_vertices.size();
         
         while (*text)
         {
-                int c = (unsigned char)*text;
+                const unsigned c = decodeUtf8(&text);
                 if (c == '\t')
                 {
                         for (int i = 0; i < 4; ++i)
                         {
-                                if (x < g_tabStops[i]+ox)
+                                if (px < g_tabStops[i]*g_pixelScale+ox)
                                 {
-                                        x = g_tabStops[i]+ox;
+                                        px = g_tabStops[i]*g_pixelScale+ox;
                                         break;
                                 }
                         }
                 }
-                else if (c >= 32 && c < 128)
-                {                       
-                        stbtt_aligned_quad q;
-                        getBakedQuad(g_cdata, 512,512, c-32, &x,&y,&q);
-
-                        float v[12] = {
-                                        q.x0, q.y0, 
-                                        q.x1, q.y1,
-                                        q.x1, q.y0, 
-                                        q.x0, q.y0,
-                                        q.x0, q.y1, 
-                                        q.x1, q.y1, 
-                                      };
-                        float uv[12] = {
-                                        q.s0, q.t0,
-                                        q.s1, q.t1,
-                                        q.s1, q.t0,
-                                        q.s0, q.t0, 
-                                        q.s0, q.t1, 
-                                        q.s1, q.t1, 
-                                      };
-                        float c[24] = {
-                                        r, g, b, a,
-                                        r, g, b, a,
-                                        r, g, b, a,
-                                        r, g, b, a,
-                                        r, g, b, a,
-                                        r, g, b, a,
-                                      };
-                        glBindVertexArray(g_vao);
-                        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[0]);
-                        glBufferData(GL_ARRAY_BUFFER, 12*sizeof(float), v, GL_STATIC_DRAW);
-                        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[1]);
-                        glBufferData(GL_ARRAY_BUFFER, 12*sizeof(float), uv, GL_STATIC_DRAW);
-                        glBindBuffer(GL_ARRAY_BUFFER, g_vbos[2]);
-                        glBufferData(GL_ARRAY_BUFFER, 24*sizeof(float), c, GL_STATIC_DRAW);
-                        glDrawArrays(GL_TRIANGLES, 0, 6);
-
+                else if (c >= 32)
+                {
+                        imguiGlyph* g = getGlyph(c);
+                        if (!g) continue;
+                        if (g->w > 0 && g->h > 0)
+                        {
+                                // Bitmaps are drawn texel for pixel; distance fields scale smoothly.
+                                float gx = px + g->xoff*k;
+                                float gy = py - g->yoff*k;
+                                if (!g_isSdfText)
+                                {
+                                        gx = floorf(gx);
+                                        gy = floorf(gy);
+                                }
+                                const float x0 = gx*toUnits;
+                                const float y0 = gy*toUnits;
+                                const float x1 = (gx + g->w*k)*toUnits;
+                                const float y1 = (gy - g->h*k)*toUnits;
+                                const unsigned short s0 = toUnorm16((float)g->x*toUv);
+                                const unsigned short t0 = toUnorm16((float)g->y*toUv);
+                                const unsigned short s1 = toUnorm16((float)(g->x + g->w)*toUv);
+                                const unsigned short t1 = toUnorm16((float)(g->y + g->h)*toUv);
+                                if (glyphs)
+                                        glyphs[(g_vertices.size() - first)/4] = g;
+                                addVertex(x0, y0, s0, t0, col);
+                                addVertex(x1, y0, s1, t0, col);
+                                addVertex(x1, y1, s1, t1, col);
+                                addVertex(x0, y1, s0, t1, col);
+                        }
+                        px += g->xadvance*k;
                 }
-                ++text;
         }
-        
-        //glEnd();        
-        //glDisable(GL_TEXTURE_2D);
+        return (unsigned)(g_vertices.size() - first);
 }
 
+// FNV-1a of text and align; also measures text.
+static unsigned long long hashText(const char* text, int align, unsigned* length)
+{
+        unsigned long long hash = 14695981039346656037ull;
+        const char* c = text;
+        for (; *c; ++c)
+        {
+                hash ^= (unsigned char)*c;
+                hash *= 1099511628211ull;
+        }
+        hash ^= (unsigned)align;
+        hash *= 1099511628211ull;
+        *length = (unsigned)(c - text);
+        return hash ? hash : 1;
+}
 
-void imguiRenderGLDraw(int width, int height)
+static imguiGlyphRun* findGlyphRun(const char* text, int align)
 {
-        const imguiGfxCmd* q = imguiGetRenderQueue();
-        int nq = imguiGetRenderQueueSize();
+        unsigned length;
+        const unsigned long long hash = hashText(text, align, &length);
+        if (length > GLYPH_RUN_MAX_CHARS)
+        {
+                return 0;
+        }
+
+        imguiGlyphRun* oldest = 0;
+        for (unsigned i = 0; i < GLYPH_RUN_PROBES; ++i)
+        {
+                imguiGlyphRun* run = &g_glyphRuns[(hash + i) & (GLYPH_RUN_SLOTS - 1)];
+                if (run->hash == hash && run->align == align && strcmp(run->text, text) == 0)
+                {
+                        if (run->atlasGeneration != g_atlasGeneration)
+                        {
+                                oldest = run;
+                                break;
+                        }
+                        run->lastUsedFrame = g_frame;
+                        for (unsigned j = 0; j < run->vertexCount/4; ++j)
+                        {
+                                run->glyphs[j]->lastUsedFrame = g_frame;
+                        }
+                        return run;
+                }
+                if (!oldest || !run->hash ||
+                    (oldest->hash && g_frame - run->lastUsedFrame > g_frame - oldest->lastUsedFrame))
+                {
+                        oldest = run;
+                }
+        }
+
+        // Lay it out at the origin, then move the quads into the run.
+        const size_t first = g_vertices.size();
+        oldest->vertexCount = layoutText(0.0f, 0.0f, text, align, 0, oldest->glyphs);
+        memcpy(oldest->vertices, &g_vertices[first], oldest->vertexCount*sizeof(imguiVertex));
+        g_vertices.resize(first);
+
+        oldest->hash = hash;
+        oldest->atlasGeneration = g_atlasGeneration;
+        oldest->lastUsedFrame = g_frame;
+        oldest->align = align;
+        memcpy(oldest->text, text, length+1);
+        return oldest;
+}
+
+static void drawText(int x, int y, const char *text, int align, unsigned int col)
+{
+        if (!g_fontTexture) return;
+        if (!text) return;
 
+        // A run can only be moved by whole pixels.
+        const float px = (float)x*g_pixelScale;
+        const float py = (float)y*g_pixelScale;
+        const bool isPixelAligned = floorf(px) == px && floorf(py) == py;
+
+        const size_t first = g_vertices.size();
+        unsigned vertexCount;
+        const imguiGlyphRun* run = isPixelAligned ? findGlyphRun(text, align) : 0;
+        if (run)
+        {
+                vertexCount = run->vertexCount;
+                g_vertices.insert(g_vertices.end(), run->vertices, run->vertices + vertexCount);
+                for (size_t i = first; i < g_vertices.size(); ++i)
+                {
+                        g_vertices[i].x += (float)x;
+                        g_vertices[i].y += (float)y;
+                        g_vertices[i].col = col;
+                }
+        }
+        else
+        {
+                vertexCount = layoutText((float)x, (float)y, text, align, col, 0);
+        }
+
+        for (unsigned i = 0; i < vertexCount; i += 4)
+        {
+                const GLuint base = (GLuint)(first + i);
+                addTriangle(base+0, base+2, base+1);
+                addTriangle(base+0, base+3, base+2);
+        }
+        endPrimitive();
+}
+
+
+void imguiRenderGLDraw(const imguiGfxCmd* q, int nq, int width, int height, float pixelScale)
+{
         const float s = 1.0f/8.0f;
 
-        glViewport(0, 0, width, height);
-        glUseProgram(g_program);
-	glActiveTexture(GL_TEXTURE0);
-        glUniform2f(g_programViewportLocation, (float) width, (float) height);
-        glUniform1i(g_programTextureLocation, 0);
+        if (pixelScale != g_pixelScale)
+        {
+                // Glyphs of the old size age out of the atlas.
+                g_pixelScale = pixelScale;
+                clearGlyphRuns();
+        }
 
+        // Anti-aliasing fringes are one pixel wide.
+        const float fringe = 1.0f/pixelScale;
+
+        // Build the whole frame's geometry first; only scissor changes split it into batches.
+        ++g_frame;
+        g_vertices.clear();
+        g_indices.clear();
+        g_batches.clear();
+        beginBatch(false, 0, 0, 0, 0);
 
-        glDisable(GL_SCISSOR_TEST);
         for (int i = 0; i < nq; ++i)
         {
                 const imguiGfxCmd& cmd = q[i];
@@ -637,18 +1393,18 @@ void imguiRenderGLDraw(int width, int height)
                         {
                                 drawRect((float)cmd.rect.x*s+0.5f, (float)cmd.rect.y*s+0.5f,
                                                  (float)cmd.rect.w*s-1, (float)cmd.rect.h*s-1,
-                                                 1.0f, cmd.col);
+                                                 fringe, cmd.col);
                         }
                         else
                         {
                                 drawRoundedRect((float)cmd.rect.x*s+0.5f, (float)cmd.rect.y*s+0.5f,
                                                                 (float)cmd.rect.w*s-1, (float)cmd.rect.h*s-1,
-                                                                (float)cmd.rect.r*s, 1.0f, cmd.col);
+                                                                cmd.rect.r, fringe, cmd.col);
                         }
                 }
                 else if (cmd.type == IMGUI_GFXCMD_LINE)
                 {
-                        drawLine(cmd.line.x0*s, cmd.line.y0*s, cmd.line.x1*s, cmd.line.y1*s, cmd.line.r*s, 1.0f, cmd.col);
+                        drawLine(cmd.line.x0*s, cmd.line.y0*s, cmd.line.x1*s, cmd.line.y1*s, cmd.line.r*s, fringe, cmd.col);
                 }
                 else if (cmd.type == IMGUI_GFXCMD_TRIANGLE)
                 {
@@ -660,7 +1416,7 @@ void imguiRenderGLDraw(int width, int height)
                                         (float)cmd.rect.x*s+0.5f+(float)cmd.rect.w*s-1, (float)cmd.rect.y*s+0.5f+(float)cmd.rect.h*s/2-0.5f,
                                         (float)cmd.rect.x*s+0.5f, (float)cmd.rect.y*s+0.5f+(float)cmd.rect.h*s-1,
                                 };
-                                drawPolygon(verts, 3, 1.0f, cmd.col);
+                                drawPolygon(verts, 3, fringe, cmd.col);
                         }
                         if (cmd.flags == 2)
                         {
@@ -670,7 +1426,7 @@ void imguiRenderGLDraw(int width, int height)
                                         (float)cmd.rect.x*s+0.5f+(float)cmd.rect.w*s/2-0.5f, (float)cmd.rect.y*s+0.5f,
                                         (float)cmd.rect.x*s+0.5f+(float)cmd.rect.w*s-1, (float)cmd.rect.y*s+0.5f+(float)cmd.rect.h*s-1,
                                 };
-                                drawPolygon(verts, 3, 1.0f, cmd.col);
+                                drawPolygon(verts, 3, fringe, cmd.col);
                         }
                 }
                 else if (cmd.type == IMGUI_GFXCMD_TEXT)
@@ -679,16 +1435,63 @@ void imguiRenderGLDraw(int width, int height)
                 }
                 else if (cmd.type == IMGUI_GFXCMD_SCISSOR)
                 {
-                        if (cmd.flags)
+                        beginBatch(cmd.flags != 0, cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h);
+                }
+        }
+
+        if (g_indices.empty() || !g_fontTexture)
+        {
+                return;
+        }
+
+        glViewport(0, 0, (int)((float)width*pixelScale + 0.5f), (int)((float)height*pixelScale + 0.5f));
+        stateCache().UseProgram(g_program);
+        stateCache().ActiveTexture(GL_TEXTURE0);
+        glUniform2f(g_programViewportLocation, (float) width, (float) height);
+        glUniform1i(g_programTextureLocation, 0);
+        g_fontTexture->Bind();
+
+        // One upload of each stream per frame; orphaning the previous storage keeps the driver from
+        // waiting on draws that still read it.
+        stateCache().BindVertexArray(g_vao);
+        stateCache().BindBuffer(GL_ARRAY_BUFFER, g_vbos[0]);
+        glBufferData(GL_ARRAY_BUFFER, g_vertices.size()*sizeof(imguiVertex), &g_vertices[0], GL_STREAM_DRAW);
+        stateCache().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_vbos[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, g_indices.size()*sizeof(GLuint), &g_indices[0], GL_STREAM_DRAW);
+
+        glDisable(GL_SCISSOR_TEST);
+        bool isScissored = false;
+        for (size_t i = 0; i < g_batches.size(); ++i)
+        {
+                const imguiBatch& batch = g_batches[i];
+                if (batch.indexCount == 0)
+                {
+                        continue;
+                }
+
+                if (batch.isScissored)
+                {
+                        if (!isScissored)
                         {
                                 glEnable(GL_SCISSOR_TEST);
-                                glScissor(cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h);
-                        }
-                        else
-                        {
-                                glDisable(GL_SCISSOR_TEST);
+                                isScissored = true;
                         }
+                        glScissor((int)((float)batch.scissor[0]*pixelScale), (int)((float)batch.scissor[1]*pixelScale),
+                                  (int)((float)batch.scissor[2]*pixelScale), (int)((float)batch.scissor[3]*pixelScale));
                 }
+                else if (isScissored)
+                {
+                        glDisable(GL_SCISSOR_TEST);
+                        isScissored = false;
+                }
+
+                glDrawElements(GL_TRIANGLES, batch.indexCount, GL_UNSIGNED_INT,
+                               (void*)(batch.firstIndex*sizeof(GLuint)));
         }
         glDisable(GL_SCISSOR_TEST);
-}
\ No newline at end of file
+}
+
+void imguiRenderGLDraw(int width, int height)
+{
+        imguiRenderGLDraw(imguiGetRenderQueue(), imguiGetRenderQueueSize(), width, height, 1.0f);
+}
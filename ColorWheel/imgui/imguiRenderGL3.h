@@ -21,8 +21,21 @@
 #ifndef IMGUI_RENDER_GL_H
 #define IMGUI_RENDER_GL_H
 
-bool imguiRenderGLInit(const char* fontpath);
+struct imguiGfxCmd;
+
+enum imguiTextMode
+{
+        IMGUI_TEXT_BITMAP,      // Glyphs are rasterized at each pixel size they're drawn at.
+        IMGUI_TEXT_SDF,         // Each glyph is one signed distance field, drawn at any size.
+};
+
+// fontData, if given, is the contents of fontpath, already read (e.g. on another thread); it's
+// copied. Otherwise the file is read when the first glyph that isn't prebaked is drawn.
+bool imguiRenderGLInit(const char* fontpath, imguiTextMode textMode, const unsigned char* fontData = 0, int fontDataSize = 0);
 void imguiRenderGLDestroy();
 void imguiRenderGLDraw(int width, int height);
+// Draws a copy of the render queue (e.g. one taken on another thread). width and height are in GUI
+// units; pixelScale is the drawable's pixels per unit (2 on most HiDPI displays).
+void imguiRenderGLDraw(const imguiGfxCmd* commands, int count, int width, int height, float pixelScale);
 
 #endif // IMGUI_RENDER_GL_H
\ No newline at end of file
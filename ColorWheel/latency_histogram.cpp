@@ -0,0 +1,172 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <ostream>
+
+#include "latency_histogram.hpp"
+
+
+namespace
+{
+
+    double ToMilliseconds(const std::uint64_t microseconds) noexcept
+    {
+        return static_cast<double>(microseconds) / 1000.0;
+    }
+
+    // Returns: the index of value's most significant set bit; value must not be 0.
+    unsigned int MostSignificantBit(std::uint64_t value) noexcept
+    {
+        auto result = 0u;
+        while (value >>= 1u)
+        {
+            ++result;
+        }
+        return result;
+    }
+
+    const double SummaryPercentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+
+} // namespace
+
+
+LatencyHistogram::LatencyHistogram() noexcept
+{
+    Reset();
+}
+
+void LatencyHistogram::Record(const std::uint64_t microseconds) noexcept
+{
+    const auto value = (microseconds < MaxValue) ? microseconds : MaxValue;
+
+    ++_buckets[BucketIndex(value)];
+    ++_count;
+    _minimum = std::min(_minimum, value);
+    _maximum = std::max(_maximum, value);
+    _sum += value;
+}
+
+void LatencyHistogram::Reset() noexcept
+{
+    _buckets.fill(0u);
+    _count = 0u;
+    _minimum = std::numeric_limits<std::uint64_t>::max();
+    _maximum = 0u;
+    _sum = 0u;
+}
+
+std::uint64_t LatencyHistogram::Minimum() const noexcept
+{
+    return (0u == _count) ? 0u : _minimum;
+}
+
+double LatencyHistogram::Mean() const noexcept
+{
+    return (0u == _count) ? 0.0 : static_cast<double>(_sum) / static_cast<double>(_count);
+}
+
+std::uint64_t LatencyHistogram::ValueAtPercentile(const double percentile) const noexcept
+{
+    if (0u == _count)
+    {
+        return 0u;
+    }
+
+    const auto fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    const auto target = std::max<std::uint64_t>(
+        static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(_count))),
+        1u
+        );
+
+    std::uint64_t cumulative = 0u;
+    for (std::size_t i = 0u; i < BucketCount; ++i)
+    {
+        cumulative += _buckets[i];
+        if (cumulative >= target)
+        {
+            return std::min(BucketHighest(i), _maximum);
+        }
+    }
+    return _maximum;
+}
+
+void LatencyHistogram::Write(std::ostream& stream) const
+{
+    char text[128];
+    std::snprintf(
+        text,
+        sizeof(text),
+        "%llu samples, ms min %.3f mean %.3f max %.3f",
+        static_cast<unsigned long long>(_count),
+        ToMilliseconds(Minimum()),
+        Mean() / 1000.0,
+        ToMilliseconds(_maximum)
+        );
+    stream << text << std::endl;
+
+    for (const auto percentile : SummaryPercentiles)
+    {
+        std::snprintf(text, sizeof(text), "  p%-5g %10.3f", percentile, ToMilliseconds(ValueAtPercentile(percentile)));
+        stream << text << std::endl;
+    }
+
+    std::uint64_t cumulative = 0u;
+    for (std::size_t i = 0u; i < BucketCount; ++i)
+    {
+        if (0u == _buckets[i])
+        {
+            continue;
+        }
+
+        cumulative += _buckets[i];
+        std::snprintf(
+            text,
+            sizeof(text),
+            "  %10.3f %10.3f %8llu %7.3f%%",
+            ToMilliseconds(BucketLowest(i)),
+            ToMilliseconds(BucketHighest(i)),
+            static_cast<unsigned long long>(_buckets[i]),
+            100.0 * static_cast<double>(cumulative) / static_cast<double>(_count)
+            );
+        stream << text << std::endl;
+    }
+}
+
+std::size_t LatencyHistogram::BucketIndex(const std::uint64_t value) noexcept
+{
+    // The first octave is linear, one bucket per microsecond. After that, each octave is split into
+    // SubBucketCount buckets, twice as wide as the previous octave's.
+    if (value < SubBucketCount)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    const auto octave = MostSignificantBit(value) - SubBucketBits + 1u;
+    const auto subBucket = (value >> (octave - 1u)) - SubBucketCount;
+    return static_cast<std::size_t>(octave * SubBucketCount + subBucket);
+}
+
+std::uint64_t LatencyHistogram::BucketLowest(const std::size_t index) noexcept
+{
+    const auto octave = index / SubBucketCount;
+    const auto subBucket = index % SubBucketCount;
+    if (0u == octave)
+    {
+        return subBucket;
+    }
+    return (subBucket + SubBucketCount) << (octave - 1u);
+}
+
+std::uint64_t LatencyHistogram::BucketHighest(const std::size_t index) noexcept
+{
+    const auto octave = index / SubBucketCount;
+    if (0u == octave)
+    {
+        return BucketLowest(index);
+    }
+    return BucketLowest(index) + (std::uint64_t(1u) << (octave - 1u)) - 1u;
+}
@@ -0,0 +1,74 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef LATENCY_HISTOGRAM
+#define LATENCY_HISTOGRAM
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+// Log-linear latency histogram
+///////////////////////////////
+// Records microsecond values into buckets that are linear within each power of two (SubBucketCount
+// buckets per octave), in the style of HdrHistogram: any value is reported to within about 3%,
+// whatever its magnitude, and recording is a few integer operations that never allocate. Values
+// from 0 up to about 71 minutes are covered; larger ones are clamped. Every sample since the last
+// Reset() is kept, so percentiles cover the whole session rather than a recent window.
+class LatencyHistogram
+{
+public:
+    static const unsigned int SubBucketBits = 5u;
+    static const std::uint64_t SubBucketCount = 1u << SubBucketBits;
+    static const std::uint64_t MaxValue = 0xffffffffu;
+
+    LatencyHistogram() noexcept;
+
+    void Record(const std::uint64_t microseconds) noexcept;
+
+    void Reset() noexcept;
+
+    std::uint64_t Count() const noexcept
+    {
+        return _count;
+    }
+
+    // Returns: 0, if nothing has been recorded.
+    std::uint64_t Minimum() const noexcept;
+
+    std::uint64_t Maximum() const noexcept
+    {
+        return _maximum;
+    }
+
+    // Returns: 0, if nothing has been recorded.
+    double Mean() const noexcept;
+
+    // Returns: the highest value (at bucket resolution) at or below which percentile (0 to 100) of
+    //          the samples fall; 0, if nothing has been recorded.
+    std::uint64_t ValueAtPercentile(const double percentile) const noexcept;
+
+    // Writes a percentile summary, then one "from to count cumulative%" line per non-empty bucket,
+    // all in milliseconds.
+    void Write(std::ostream& stream) const;
+
+private:
+    // Octaves above the first (linear) one, up to MaxValue.
+    static const std::size_t OctaveCount = 32u - SubBucketBits;
+    static const std::size_t BucketCount = (OctaveCount + 1u) * SubBucketCount;
+
+    static std::size_t BucketIndex(const std::uint64_t value) noexcept;
+    static std::uint64_t BucketLowest(const std::size_t index) noexcept;
+    static std::uint64_t BucketHighest(const std::size_t index) noexcept;
+
+    std::array<std::uint64_t, BucketCount> _buckets;
+    std::uint64_t _count;
+    std::uint64_t _minimum;
+    std::uint64_t _maximum;
+    std::uint64_t _sum;
+};
+
+
+#endif
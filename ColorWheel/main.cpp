@@ -3,16 +3,19 @@
 
 // C++ Cross Platform Headers
 /////////////////////////////
+#include <chrono>               // For timing replays.
+#include <atomic>               // For the renderer's bind counts.
+#include <future>               // For reading files while SDL and OpenGL start.
 #include <cstdint>              // Cross-platform integers.
 #include <stdexcept>            // For std::logic_error and std::runtime_error.
 #include <string>               // Strings.
 #include <iostream>             // Console and debug output.
 #include <fstream>
-#include <sstream>              // String manipulation.
+#include <cstdio>               // For std::snprintf().
+#include <cstdlib>              // For std::getenv().
 #include <memory>               // Smart pointers.
 #include <vector>               // Dynamic arrays.
-#include <unistd.h>             // for usleep()
-#include <unordered_map>
+#include <algorithm>
 
 // Math Library
 ///////////////
@@ -34,38 +37,151 @@
 #include "gl_shader.hpp"
 #include "gl_program.hpp"
 #include "gl_buffer_object.hpp"
+#include "gl_vertex_array.hpp"
+#include "gl_state_cache.hpp"
+#include "gl_async_readback.hpp"
 
 #include "math_utils.h"
+#include "color_wheel_mesh.hpp"
 
 #include "imgui/imgui.h"
 #include "imgui/imguiRenderGL3.h"
 
 #include "sdl_startup.hpp"
 #include "gl_startup.hpp"
+#include "wheel_cache.hpp"
+#include "gui_cache.hpp"
+#include "frame_timing.hpp"
+#include "animation.hpp"
+#include "trace.hpp"
+#include "session_recording.hpp"
+#include "redraw_scheduler.hpp"
+#include "frame_packet.hpp"
+#include "render_thread.hpp"
+#include "array_pool.hpp"
+#include "alloc_tracker.hpp"
 
 
 // Application Constants
 ////////////////////////
 const char WindowName[] = "Cross Platform Skeleton";
+const char FontName[] = "DroidSans.ttf";
 const glm::ivec2 ScreenSize(1024, 768);
 const auto VerticalFov = trig::_60Degrees;
 
+// Command Line Options
+///////////////////////
+struct Options
+{
+    std::string recordPath;     // --record <file>: write the session's input and frame deltas.
+    std::string replayPath;     // --replay <file>: play a recorded session back, then exit.
+    double      fixedStep;      // --fixed-step <ms>: use a constant delta_t; 0 uses the clock.
+    bool        isHeadless;     // --headless: replay without showing the window.
+    bool        isFast;         // --fast: don't wait for vertical sync.
+    bool        isSingleThreaded;   // --single-thread: render on the game loop's thread.
+    bool        isLatencyFenced;    // --latency-fence: also time input until the GPU finishes.
+    bool        isZeroAllocationRequired;   // --require-zero-alloc: fail a replay that allocates.
+    bool        isSdfText;          // --sdf-text: draw the GUI's text from signed distance fields.
+};
+
+const char Usage[] =
+    "usage: ColorWheel [--record <file>] [--replay <file> [--headless]] [--fixed-step <ms>] [--fast]\n"
+    "                  [--single-thread] [--latency-fence] [--require-zero-alloc] [--sdf-text]";
+
+// Throws:  std::invalid_argument : unknown or malformed options.
+Options ParseCommandLine(const int argc, const char* const argv[])
+{
+    Options options { std::string(), std::string(), 0.0, false, false, false, false, false, false };
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string option(argv[i]);
+        const auto hasValue = i + 1 < argc;
+
+        if ("--record" == option && hasValue)
+        {
+            options.recordPath = argv[++i];
+        }
+        else if ("--replay" == option && hasValue)
+        {
+            options.replayPath = argv[++i];
+        }
+        else if ("--fixed-step" == option && hasValue)
+        {
+            char* pEnd = nullptr;
+            options.fixedStep = std::strtod(argv[++i], &pEnd);
+            if ('\0' != *pEnd || !(0.0 < options.fixedStep))
+            {
+                throw std::invalid_argument("--fixed-step must be a positive number of milliseconds");
+            }
+        }
+        else if ("--headless" == option)
+        {
+            options.isHeadless = true;
+        }
+        else if ("--fast" == option)
+        {
+            options.isFast = true;
+        }
+        else if ("--single-thread" == option)
+        {
+            options.isSingleThreaded = true;
+        }
+        else if ("--latency-fence" == option)
+        {
+            options.isLatencyFenced = true;
+        }
+        else if ("--require-zero-alloc" == option)
+        {
+            options.isZeroAllocationRequired = true;
+        }
+        else if ("--sdf-text" == option)
+        {
+            options.isSdfText = true;
+        }
+        else if ("-psn_" == option.substr(0, 5))
+        {
+            // Finder (on older versions of OS X) passes a process serial number; ignore it.
+        }
+        else
+        {
+            throw std::invalid_argument("unknown or incomplete option: " + option);
+        }
+    }
+
+    if (options.isHeadless && options.replayPath.empty())
+    {
+        throw std::invalid_argument("--headless requires --replay");
+    }
+
+    if (options.isZeroAllocationRequired && options.replayPath.empty())
+    {
+        throw std::invalid_argument("--require-zero-alloc requires --replay");
+    }
+    if (!options.recordPath.empty() && options.recordPath == options.replayPath)
+    {
+        throw std::invalid_argument("--record and --replay can't use the same file");
+    }
+
+    return options;
+}
+
 // OpenGL stuff
 ///////////////
 enum class Vbo
 : GLuint
 {
     Vertices    = 0u,
-    Color       = 1000u,
-    AltColor    = 2000u,
-    Saturation  = 3000u,
-};
+    Color       = 1u,
+    AltColor    = 2u,
+    Saturation  = 3u,
 
-// OpenGL Buffer Object IDs
-GLuint vertexArrayObjectName;
+    Count
+};
 
+// OpenGL Buffer Objects, indexed by Vbo. (Indexing a vector never allocates.)
 typedef gl::BufferObject<gl::BufferObjectType::Array> vertex_buffer_obj;
-std::unordered_map<GLuint, vertex_buffer_obj> vertexBufferObjects;
+std::vector<vertex_buffer_obj> vertexBufferObjects;
 
 // Uniform locations
 GLint projectionMatrixLocation = -1;
@@ -87,270 +203,56 @@ glm::mat4 modelViewMatrix;
 enum class ColorModel { Rgb, Ryb };
 enum class ColorSpace : GLint { Undefined = 0, ColorWheel, Hsl, Hsv, Hsi, Hsy };
 
-const auto MinHues = 6;
-const auto MinSaturations = 2;
-
-const auto MaxHueTessellations = 7;
-const auto MaxSaturationTessellations = 8;
-const auto WheelInnerRadius = 0.5f;
-
-const double RgbColorModel[] =
-{
-    1.0, 0.0, 0.0, // Red
-    //1.0, 0.5, 0.0, // Orange
-    1.0, 1.0, 0.0, // Yellow
-    //0.5, 1.0, 0.0, // Chartreuse
-    0.0, 1.0, 0.0, // Green
-    //0.0, 1.0, 0.5, // Spring
-    0.0, 1.0, 1.0, // Cyan
-    //0.0, 0.5, 1.0, // Azure
-    0.0, 0.0, 1.0, // Blue
-    //0.5, 0.0, 1.0, // Violet
-    1.0, 0.0, 1.0, // Magenta
-    //1.0, 0.0, 0.5, // Rose
-};
-
-const double RybColorModel[] = // RYB
-{
-    double(0xfe) / 0xff, double(0x27) / 0xff, double(0x12) / 0xff, // Red
-    double(0xfb) / 0xff, double(0x99) / 0xff, double(0x02) / 0xff, // Orange
-    double(0xfe) / 0xff, double(0xfe) / 0xff, double(0x33) / 0xff, // Yellow
-    double(0x66) / 0xff, double(0xb0) / 0xff, double(0x32) / 0xff, // Green
-    double(0x02) / 0xff, double(0x47) / 0xff, double(0xfe) / 0xff, // Blue
-    double(0x86) / 0xff, double(0x01) / 0xff, double(0xaf) / 0xff, // Violet
-};
-
-
-template<size_t ColorModelSize>
-void CalculateHueForColorModel(
-    const double hueRadians,
-    const double (&colorModel)[ColorModelSize],
-    glm::dvec3& color
-    )
-{
-    using namespace trig;
-    static_assert(0 != ColorModelSize, "ColorModelSize == 0");
-
-    const int ColorCount = ColorModelSize / 3;
-    assert(0 != ColorCount);
 
-    const double ColorRange = TwoPi / ColorCount;
-    const double clampedHue = ClampRadians(hueRadians);
-
-    const int lowerColor = (int(clampedHue / ColorRange) >= ColorCount) ?
-        ColorCount - 1 : int(clampedHue / ColorRange);
-    const int upperColor = (lowerColor + 1 >= ColorCount) ? 0 : lowerColor + 1;
-
-    const double distFromLower = clampedHue - (lowerColor * ColorRange);
-
-    const double upperContribution = distFromLower / ColorRange;
-    const double lowerContribution = 1.0 - upperContribution;
-
-    const int i = lowerColor * 3;
-    const int j = upperColor * 3;
-    color.r = (lowerContribution * colorModel[i + 0]) + (upperContribution * colorModel[j + 0]);
-    color.g = (lowerContribution * colorModel[i + 1]) + (upperContribution * colorModel[j + 1]);
-    color.b = (lowerContribution * colorModel[i + 2]) + (upperContribution * colorModel[j + 2]);
-}
-
-
-// Must make sure there's room reserved for (colorCount * 4) additional glm::vec3s.
-//      colorWheelColors.reserve(colorWheelColors.size() + (colorCount * 4));
-// Returns: iterator pointing to end()
-template<
-    typename iterator_type,
-    typename std::enable_if<
-        std::is_same<typename std::iterator_traits<iterator_type>::value_type, glm::vec3>::value
-        >::type* = nullptr
-    >
-iterator_type CreateColorWheelColors(
-    const unsigned int colorCount,
-    const unsigned int trackCount,
-    const double (&colorModel)[3 * 6],
-    const iterator_type position
-    )
+void InitializeVertexArrayBufferObjects()
 {
-    const auto SliceStep = trig::TwoPi / static_cast<decltype(trig::TwoPi)>(colorCount);
-
-    auto it = position;
-    auto hue = 0.0;
-    glm::dvec3 color;
-
-    for (auto j = 0; j < colorCount; ++j, hue += SliceStep)
-    {
-        CalculateHueForColorModel(hue, colorModel, color);
-
-        // 4 points per quad
-        for (auto i = 0; i < 4; ++i, ++it)
-        {
-            *it = color;
-        }
-    }
-
-    // Copy the colors of the first track to all the rest.
-    for (auto j = 1; j < trackCount; ++j)
+    vertexBufferObjects.reserve(static_cast<std::size_t>(Vbo::Count));
+    while (vertexBufferObjects.size() < static_cast<std::size_t>(Vbo::Count))
     {
-        auto srcIt = position;
-        for (auto i = 0; i < colorCount * 4; ++i, ++srcIt, ++it)
-        {
-            *it = *srcIt;
-        }
+        vertexBufferObjects.emplace_back();
     }
-
-    return it;
 }
 
 
-// Must make sure there's room reserved for (trackCount * sectorCount * 4) additional glm::vec2s.
-//      colorWheelVerts.reserve(colorWheelVerts.size() + (trackCount * sectorCount * 4));
-// Returns: iterator pointing to end()
-template<
-    typename iterator_type,
-    typename std::enable_if<
-        std::is_same<typename std::iterator_traits<iterator_type>::value_type, glm::vec2>::value
-        >::type* = nullptr
-    >
-iterator_type CreateColorWheelGeometry(
-    const unsigned int  sectorCount,
-    const unsigned int  trackCount,
-    const float         innerRadius,        // inner radius of the color wheel
-    const float         sectorBlendT,
-    const float         trackBlendT,
-    const iterator_type position
-    )
+// Mesh Generation
+//////////////////
+// Each function replaces arrays of the mesh with newly generated ones; an array that may have been
+// handed to the renderer is never modified. The arrays come from pools, so regenerating the mesh
+// stops allocating once every size in use has been generated a few times.
+struct MeshPools
 {
-    assert(sectorCount >= 2);
-    assert(sectorCount % 2 == 0);
-    assert(trackCount == 1 || trackCount % 2 == 0);
-
-    const auto SliceStep = trig::TwoPi / sectorCount; // Radians of a single slice.
-    const auto SectorHalfBlend = sectorBlendT / 2.0; // Clamp sector blend from [0.0, 0.5].
-    // Blend even slice half-size from [1.0, 0.5].
-    const auto EvenSectorHalfAngle = SliceStep * (1.0 - SectorHalfBlend);
-    // Blend odd slice half-size from [0.0, 0.5].
-    const auto OddSectorHalfAngle = SliceStep * SectorHalfBlend;
-
-    // Width of a single track.
-    const auto TrackStep = (trackCount > 0) ? (1.0 - innerRadius) / trackCount : 1.0 - innerRadius;
-    // Blend even track width from double track to single track width.
-    const auto EvenTrackWidth = TrackStep + TrackStep * (1.0 - trackBlendT);
-    // Blend odd track width from [0.0, 1.0].
-    const auto OddTrackWidth = TrackStep * trackBlendT;
-    const auto minTracks = (0 != trackCount) ? trackCount : 1;
-
-    auto it = position;
-    auto trackInnerRadius = innerRadius;
-    auto isEvenTrack = true;
-
-    for (auto j = 0; j < minTracks; j += 2)
+    ArrayPool<GLint>        trackStarts;
+    ArrayPool<GLsizei>      trackCounts;
+    ArrayPool<GLfloat>      saturation;
+    ArrayPool<glm::vec3>    colors;
+    ArrayPool<glm::vec3>    altColors;
+    ArrayPool<glm::vec2>    vertices;
+
+    // Returns: how many times any of the pools has had to allocate.
+    std::size_t GrowthCount() const noexcept
     {
-        for (auto k = 0; k < 2; ++k)
-        {
-            const auto              Inner = trackInnerRadius;
-            const decltype(Inner)   Outer = Inner + ((isEvenTrack) ? EvenTrackWidth : OddTrackWidth);
-
-            auto sectorAngle = 0.0;
-
-            for (auto l = 0; l < sectorCount; l += 2)
-            {
-                auto isEvenSector = true;
-                
-                for (auto m = 0; m < 2; ++m)
-                {
-                    const auto SectorHalfAngle = (isEvenSector) ?
-                        EvenSectorHalfAngle : OddSectorHalfAngle;
-                    const auto lower = sectorAngle - SectorHalfAngle;
-                    const auto upper = sectorAngle + SectorHalfAngle;
-                    const auto lr = glm::vec2(std::cos(lower), std::sin(lower));
-                    const auto ur = glm::vec2(std::cos(upper), std::sin(upper));
-
-                    *it++ = lr * Inner;
-                    *it++ = lr * Outer;
-                    *it++ = ur * Inner;
-                    *it++ = ur * Outer;
-
-                    sectorAngle += SliceStep;
-
-                    isEvenSector = !isEvenSector;
-                }
-            }
-
-            trackInnerRadius = Outer;
-
-            isEvenTrack = !isEvenTrack;
-        }
+        return trackStarts.GrowthCount() + trackCounts.GrowthCount() + saturation.GrowthCount() +
+            colors.GrowthCount() + altColors.GrowthCount() + vertices.GrowthCount();
     }
-
-    return it;
-}
+};
 
 
-template<
-    typename iterator_type,
-    typename std::enable_if<
-        std::is_same<typename std::iterator_traits<iterator_type>::value_type, GLfloat>::value
-        >::type* = nullptr
-    >
-iterator_type CreateColorWheelSaturation(
-    const unsigned int  sectorCount,
-    const unsigned int  trackCount,
-    const float         trackBlendT,
-    const iterator_type position
+void CreateIndices(
+    const unsigned int colorCount,
+    const unsigned int trackCount,
+    WheelMesh& mesh,
+    MeshPools& pools
     )
 {
-    assert(trackCount == 1 || trackCount % 2 == 0);
-
-    // Relative width of a single track for a unit circle.
-    const auto TrackStep = (trackCount > 0) ? 1.0 / trackCount : 1.0;
-    // Blend even track width from double track to single track width.
-    const auto EvenTrackWidth = TrackStep + TrackStep * (1.0 - trackBlendT);
-    // Blend odd track width from [0.0, 1.0].
-    const auto OddTrackWidth = TrackStep * trackBlendT;
     const auto minTracks = (0 != trackCount) ? trackCount : 1;
 
-    auto it = position;
-    auto trackInnerRadius = 0.0f;
-    auto isEven = trackCount >= 2;
-
-    for (auto j = 0; j < minTracks; ++j)
-    {
-        const float Outer = trackInnerRadius + (isEven ? EvenTrackWidth : OddTrackWidth);
-        isEven = !isEven;
+    auto pStarts = pools.trackStarts.Acquire(minTracks);
+    auto pCounts = pools.trackCounts.Acquire(minTracks);
+    RecalculateIndices(colorCount, trackCount, *pStarts, *pCounts);
 
-        for (auto k = 0; k < sectorCount; ++k)
-        {
-            for (auto l = 0; l < 4; ++l)
-            {
-                *it++ = Outer; // Change to Inner for smooth shading.
-            }
-        }
-
-        trackInnerRadius = Outer;
-    }
-
-    return it;
-}
-
-
-// 6, 12, 24, 48, 96, 192, 384
-inline constexpr int ColorCountForTessellation(const int divisions)
-{
-    return MinHues * (1 << divisions);
-}
-
-
-inline constexpr int SaturationCountForTessellation(const int divisions)
-{
-    return 2 << divisions;
-}
-
-
-void InitializeVertexArrayBufferObjects()
-{
-    vertexBufferObjects.emplace(std::make_pair(static_cast<GLuint>(Vbo::Saturation), vertex_buffer_obj()));
-    vertexBufferObjects.emplace(std::make_pair(static_cast<GLuint>(Vbo::Color), vertex_buffer_obj()));
-    vertexBufferObjects.emplace(std::make_pair(static_cast<GLuint>(Vbo::AltColor), vertex_buffer_obj()));
-    vertexBufferObjects.emplace(std::make_pair(static_cast<GLuint>(Vbo::Vertices), vertex_buffer_obj()));
+    mesh.pTrackStarts = std::move(pStarts);
+    mesh.pTrackCounts = std::move(pCounts);
+    mesh.trackCount = trackCount;
 }
 
 
@@ -358,58 +260,44 @@ void CreateSaturation(
     const unsigned int colorCount,
     const unsigned int trackCount,
     const float trackBlendT,
-    std::vector<GLfloat>& colorWheelSaturation
+    WheelMesh& mesh,
+    MeshPools& pools,
+    FrameTimings& timings
     )
 {
     const auto minTracks = (0 != trackCount) ? trackCount : 1;
     const auto TotalVertices = minTracks * colorCount * 4;
 
-    if (colorWheelSaturation.size() < TotalVertices)
-    {
-        colorWheelSaturation.resize(TotalVertices);
-    }
-
-    CreateColorWheelSaturation(colorCount, minTracks, trackBlendT, std::begin(colorWheelSaturation));
+    ScopedCpuTimer timer(timings, FrameStage::MeshGeneration);
 
-    auto& saturationBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Saturation)];
-    saturationBuffer.Bind();
-    saturationBuffer.Data(gl::UsagePattern::StaticDraw, &colorWheelSaturation[0], TotalVertices);
+    auto pSaturation = pools.saturation.Acquire(TotalVertices);
+    CreateColorWheelSaturation(colorCount, minTracks, trackBlendT, std::begin(*pSaturation));
+    mesh.pSaturation = std::move(pSaturation);
 }
 
 
 void CreateColors(
     const unsigned int colorCount,
     const unsigned int trackCount,
-    std::vector<glm::vec3>& colorWheelColors,
-    std::vector<glm::vec3>& altColorWheelColors
+    WheelMesh& mesh,
+    MeshPools& pools,
+    FrameTimings& timings
     )
 {
     const auto minTracks = (0 != trackCount) ? trackCount : 1;
     const auto TotalVertices = minTracks * colorCount * 4;
 
-    if (colorWheelColors.size() < TotalVertices)
-    {
-        colorWheelColors.resize(TotalVertices);
-    }
+    ScopedCpuTimer timer(timings, FrameStage::MeshGeneration);
 
-    if (altColorWheelColors.size() < TotalVertices)
-    {
-        altColorWheelColors.resize(TotalVertices);
-    }
-
-    auto colorIt = std::begin(colorWheelColors);
+    auto pColors = pools.colors.Acquire(TotalVertices);
+    auto colorIt = std::begin(*pColors);
     CreateColorWheelColors(colorCount, minTracks, RgbColorModel, colorIt);
+    mesh.pColors = std::move(pColors);
 
-    colorIt = std::begin(altColorWheelColors);
+    auto pAltColors = pools.altColors.Acquire(TotalVertices);
+    colorIt = std::begin(*pAltColors);
     CreateColorWheelColors(colorCount, minTracks, RybColorModel, colorIt);
-
-    auto& colorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Color)];
-    colorBuffer.Bind();
-    colorBuffer.Data(gl::UsagePattern::DynamicDraw, &colorWheelColors[0], TotalVertices);
-
-    auto& altColorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::AltColor)];
-    altColorBuffer.Bind();
-    altColorBuffer.Data(gl::UsagePattern::DynamicDraw, &altColorWheelColors[0], TotalVertices);
+    mesh.pAltColors = std::move(pAltColors);
 }
 
 
@@ -419,18 +307,18 @@ void CreateGeometry(
     const float             innerRadius,
     const float             sectorBlendT,
     const float             trackBlendT,
-    std::vector<glm::vec2>& colorWheelVerts
+    WheelMesh&              mesh,
+    MeshPools&              pools,
+    FrameTimings&           timings
     )
 {
     const auto minTracks = (0 != trackCount) ? trackCount : 1;
     const auto TotalVertices = minTracks * sectorCount * 4;
 
-    if (colorWheelVerts.size() < TotalVertices)
-    {
-        colorWheelVerts.resize(TotalVertices);
-    }
+    ScopedCpuTimer timer(timings, FrameStage::MeshGeneration);
 
-    auto vertIt = std::begin(colorWheelVerts);
+    auto pVertices = pools.vertices.Acquire(TotalVertices);
+    auto vertIt = std::begin(*pVertices);
     vertIt = CreateColorWheelGeometry(
         sectorCount,
         minTracks,
@@ -439,30 +327,44 @@ void CreateGeometry(
         trackBlendT,
         vertIt
         );
-
-    auto& vertexBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Vertices)];
-    vertexBuffer.Bind();
-    vertexBuffer.Data(gl::UsagePattern::DynamicDraw, &colorWheelVerts[0], TotalVertices);
+    mesh.pVertices = std::move(pVertices);
 }
 
 
-inline void RecalculateIndices(
-    const unsigned int      sectorCount,
-    const unsigned int      trackCount,
-    std::vector<GLint>&     trackStartPositions,
-    std::vector<GLsizei>&   trackIndiceCounts
-    )
+// Rendering
+////////////
+// The GL objects frames are drawn with, and what was last sent to them. Only the thread that owns
+// the GL context uses it; except for the bind counts, which the GUI displays.
+struct Renderer
 {
-    const auto minTracks = (0 != trackCount) ? trackCount : 1;
-    const auto ElementsPerTrack = sectorCount * 4;
-    auto startPosition = 0;
-
-    for (auto i = 0; i < minTracks; ++i, startPosition += ElementsPerTrack)
-    {
-        trackStartPositions[i] = startPosition;
-        trackIndiceCounts[i] = ElementsPerTrack;
-    }
-}
+    gl::Program*                pShader;
+    gl::VertexArray*            pWheelVertexArray;
+    WheelCache*                 pWheelCache;
+    GuiCache*                   pGuiCache;
+    FrameTimings*               pTimings;
+    const sdl::WindowHandle*    pWindowHandle;
+    glm::mat4                   initialModelViewMatrix;
+
+    bool                        hasUploadedUniforms;
+    WheelUniforms               uploadedUniforms;
+    WheelMesh                   uploadedMesh;
+
+    // The newest input event whose latency has been measured; the game loop reads the atomic copy
+    // to stop passing events along.
+    bool                                    isLatencyFenced;
+    FrameTimings::clock::time_point         lastMeasuredInput;
+    std::atomic<FrameTimings::clock::rep>   measuredInputTicks;
+
+    std::atomic<std::uint32_t>  issuedBinds;
+    std::atomic<std::uint32_t>  elidedBinds;
+
+    // Heap allocations made drawing the last frame, and every frame so far.
+    std::atomic<std::uint64_t>  frameAllocations;
+    std::atomic<std::uint64_t>  totalAllocations;
+
+    // When the first frame's swap returned; zero until then.
+    std::atomic<FrameTimings::clock::rep>   firstFrameTicks;
+};
 
 
 inline void DrawColorWheel(
@@ -482,12 +384,255 @@ inline void DrawColorWheel(
 }
 
 
+// Sends the uniforms that differ from the ones last sent; any change invalidates the wheel cache.
+// NOTE: The wheel shader must be in use.
+void UploadUniforms(Renderer& renderer, const WheelUniforms& uniforms)
+{
+    auto& shader = *renderer.pShader;
+    const auto& uploaded = renderer.uploadedUniforms;
+    const auto isFirst = !renderer.hasUploadedUniforms;
+    auto isChanged = false;
+
+    if (isFirst || uploaded.colorBlendT != uniforms.colorBlendT)
+    {
+        shader.SetUniform(colorBlendTLocation, uniforms.colorBlendT);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.colorSpace0 != uniforms.colorSpace0)
+    {
+        shader.SetUniform(colorSpace0Location, uniforms.colorSpace0);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.colorSpace1 != uniforms.colorSpace1)
+    {
+        shader.SetUniform(colorSpace1Location, uniforms.colorSpace1);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.colorSpaceBlendT != uniforms.colorSpaceBlendT)
+    {
+        shader.SetUniform(colorSpaceBlendTLocation, uniforms.colorSpaceBlendT);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.lightness != uniforms.lightness)
+    {
+        shader.SetUniform(lightnessLocation, uniforms.lightness);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.value != uniforms.value)
+    {
+        shader.SetUniform(valueLocation, uniforms.value);
+        isChanged = true;
+    }
+    if (isFirst || uploaded.coneScale != uniforms.coneScale)
+    {
+        if (1.0f == uniforms.coneScale)
+        {
+            shader.SetUniform(modelViewMatrixLocation, renderer.initialModelViewMatrix);
+        }
+        else
+        {
+            modelViewMatrix = glm::scale(renderer.initialModelViewMatrix, glm::vec3(uniforms.coneScale));
+            shader.SetUniform(modelViewMatrixLocation, modelViewMatrix);
+        }
+        isChanged = true;
+    }
+    gl::VerifyNoErrors();
+
+    if (isChanged)
+    {
+        renderer.pWheelCache->Invalidate();
+    }
+    renderer.uploadedUniforms = uniforms;
+    renderer.hasUploadedUniforms = true;
+}
+
+
+// Sends the mesh arrays that differ from the ones last sent; any change invalidates the wheel cache.
+void UploadMesh(Renderer& renderer, const WheelMesh& mesh)
+{
+    auto& uploaded = renderer.uploadedMesh;
+    if (uploaded.pSaturation == mesh.pSaturation &&
+        uploaded.pColors == mesh.pColors &&
+        uploaded.pAltColors == mesh.pAltColors &&
+        uploaded.pVertices == mesh.pVertices)
+    {
+        return;
+    }
+
+    TRACE_SCOPE("Mesh upload");
+    ScopedCpuTimer cpuTimer(*renderer.pTimings, FrameStage::Upload);
+    ScopedGpuTimer gpuTimer(*renderer.pTimings, FrameStage::Upload);
+
+    if (uploaded.pSaturation != mesh.pSaturation)
+    {
+        TRACE_SCOPE("Data(saturation)");
+        auto& saturationBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Saturation)];
+        saturationBuffer.Bind();
+        saturationBuffer.Data(gl::UsagePattern::StaticDraw, *mesh.pSaturation);
+    }
+    if (uploaded.pColors != mesh.pColors)
+    {
+        TRACE_SCOPE("Data(color)");
+        auto& colorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Color)];
+        colorBuffer.Bind();
+        colorBuffer.Data(gl::UsagePattern::DynamicDraw, *mesh.pColors);
+    }
+    if (uploaded.pAltColors != mesh.pAltColors)
+    {
+        TRACE_SCOPE("Data(altColor)");
+        auto& altColorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::AltColor)];
+        altColorBuffer.Bind();
+        altColorBuffer.Data(gl::UsagePattern::DynamicDraw, *mesh.pAltColors);
+    }
+    if (uploaded.pVertices != mesh.pVertices)
+    {
+        TRACE_SCOPE("Data(position)");
+        auto& vertexBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Vertices)];
+        vertexBuffer.Bind();
+        vertexBuffer.Data(gl::UsagePattern::DynamicDraw, *mesh.pVertices);
+    }
+
+    uploaded = mesh;
+    renderer.pWheelCache->Invalidate();
+}
+
+
+// Draws packet, and swaps it onto the window.
+void RenderFrame(Renderer& renderer, const FramePacket& packet)
+{
+    TRACE_SCOPE("Render frame");
+    const alloc_tracker::Scope allocationScope;
+    auto& frameTimings = *renderer.pTimings;
+    auto& wheelCache = *renderer.pWheelCache;
+
+    frameTimings.CollectGpuTimes();
+
+    ::glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+    ::glClear(GL_COLOR_BUFFER_BIT); // GL_DEPTH_BUFFER_BIT |
+
+    auto& stateCache = gl::StateCache::Instance();
+    stateCache.BeginFrame();
+
+    renderer.pWheelVertexArray->Bind();
+    {
+        renderer.pShader->Use();
+        UploadUniforms(renderer, packet.uniforms);
+        UploadMesh(renderer, packet.mesh);
+
+        TRACE_SCOPE("Wheel draw");
+        ScopedCpuTimer cpuTimer(frameTimings, FrameStage::WheelDraw);
+        ScopedGpuTimer gpuTimer(frameTimings, FrameStage::WheelDraw);
+
+        // Only re-rasterize the wheel when something changed; otherwise, composite the previous
+        // result.
+        if (!wheelCache.IsValid())
+        {
+            wheelCache.BeginCapture();
+            DrawColorWheel(packet.mesh.trackCount, *packet.mesh.pTrackStarts, *packet.mesh.pTrackCounts);
+            wheelCache.EndCapture();
+        }
+        wheelCache.Composite();
+    }
+    gl::VertexArray::Unbind();
+
+    {
+        TRACE_SCOPE("imgui draw");
+        ScopedCpuTimer cpuTimer(frameTimings, FrameStage::Gui);
+        ScopedGpuTimer gpuTimer(frameTimings, FrameStage::Gui);
+        renderer.pGuiCache->Draw(packet.guiCommands.data(), static_cast<int>(packet.guiCommands.size()));
+    }
+    gl::VerifyNoErrors();
+
+    {
+        TRACE_SCOPE("SDL_GL_SwapWindow");
+        ::SDL_GL_SwapWindow(*renderer.pWindowHandle);
+    }
+    const auto swapped = FrameTimings::clock::now();
+    if (0 == renderer.firstFrameTicks.load(std::memory_order_relaxed))
+    {
+        renderer.firstFrameTicks.store(swapped.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    // Measure the input events this is the first frame to show.
+    const auto& inputTimes = packet.inputTimes;
+    const auto firstNewInput = std::upper_bound(inputTimes.begin(), inputTimes.end(), renderer.lastMeasuredInput);
+    if (firstNewInput != inputTimes.end())
+    {
+        // Waiting on a fence stalls the next frame's commands, so it's only done when asked for.
+        auto isFenced = false;
+        auto fenced = swapped;
+        if (renderer.isLatencyFenced)
+        {
+            TRACE_SCOPE("Latency fence");
+            gl::SyncObject fence;
+            isFenced = fence.Wait(100000000u);  // 100 ms
+            fenced = FrameTimings::clock::now();
+        }
+
+        for (auto input = firstNewInput; input != inputTimes.end(); ++input)
+        {
+            frameTimings.AddInputLatency(swapped - *input);
+            if (isFenced)
+            {
+                frameTimings.AddFencedInputLatency(fenced - *input);
+            }
+        }
+
+        renderer.lastMeasuredInput = inputTimes.back();
+        renderer.measuredInputTicks.store(renderer.lastMeasuredInput.time_since_epoch().count());
+    }
+
+    const auto& counts = stateCache.LastFrameCounts();
+    renderer.issuedBinds.store(counts.issued, std::memory_order_relaxed);
+    renderer.elidedBinds.store(counts.elided, std::memory_order_relaxed);
+
+    const auto allocations = allocationScope.Elapsed().allocations;
+    renderer.frameAllocations.store(allocations, std::memory_order_relaxed);
+    renderer.totalAllocations.fetch_add(allocations, std::memory_order_relaxed);
+}
+
+
+// Startup
+//////////
+// When the process started, and the files being read while SDL and OpenGL initialize.
+struct Startup
+{
+    FrameTimings::clock::time_point         launched;
+    FrameTimings::clock::time_point         contextCreated;
+    std::future<std::vector<unsigned char>> fontFile;
+};
+
+
+// Returns: the file's contents; empty if it can't be read.
+// Throws:  std::bad_alloc
+std::vector<unsigned char> ReadBinaryFile(const std::string& path)
+{
+    std::vector<unsigned char> contents;
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (ifs)
+    {
+        contents.resize(static_cast<std::size_t>(ifs.tellg()));
+        ifs.seekg(0);
+        ifs.read(reinterpret_cast<char*>(contents.data()), contents.size());
+        contents.resize(static_cast<std::size_t>(ifs.gcount()));
+    }
+    return contents;
+}
+
+
 // GUI
 //////
-void InitializeGui()
+// fontFile is the font's contents, if they were read ahead; otherwise the renderer reads it when
+// it needs to.
+void InitializeGui(const bool isSdfText, const std::vector<unsigned char>& fontFile)
 {
     // Init UI
-    if (!::imguiRenderGLInit("DroidSans.ttf"))
+    if (!::imguiRenderGLInit(
+        FontName,
+        isSdfText ? IMGUI_TEXT_SDF : IMGUI_TEXT_BITMAP,
+        fontFile.empty() ? nullptr : fontFile.data(),
+        static_cast<int>(fontFile.size())
+        ))
     {
         throw std::runtime_error("Could not init GUI renderer.");
     }
@@ -496,12 +641,12 @@ void InitializeGui()
 
 // A simple game loop.
 //////////////////////
-void RunGameLoop(const sdl::WindowHandle& windowHandle)
+// Returns: the process exit status.
+int RunGameLoop(const sdl::WindowHandle& windowHandle, const sdl::GlContext& context, const Options& options, Startup& startup)
 {
     const auto pShader = InitializeGraphics(
         ScreenSize,
         VerticalFov,
-        vertexArrayObjectName,
         projectionMatrixLocation,
         modelViewMatrixLocation,
         colorBlendTLocation,
@@ -514,94 +659,61 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
         modelViewMatrix
     );
 
-    const auto InitialModelViewMatrix = modelViewMatrix;
-
-    // Create some data buffers
-    const auto MaxColorCount = ColorCountForTessellation(MaxHueTessellations) *
-        SaturationCountForTessellation(MaxSaturationTessellations);
-    const auto TotalVertices = MaxColorCount * 4;
-
-    std::vector<GLfloat>    colorWheelSaturation(TotalVertices);
-
-    std::vector<glm::vec3>  colorWheelColors(TotalVertices);
-    std::vector<glm::vec3>  altColorWheelColors(TotalVertices);
-
-    std::vector<glm::vec2>  colorWheelVerts(TotalVertices);
+    FrameTimings frameTimings;
 
+    // The buffers are filled by the renderer, from the first frame's mesh.
     InitializeVertexArrayBufferObjects();
-
-    CreateSaturation(MinHues, MinSaturations, 0.0f, colorWheelSaturation);
     auto& saturationBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Saturation)];
-
-    CreateColors(MinHues, MinSaturations, colorWheelColors, altColorWheelColors);
     auto& colorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Color)];
     auto& altColorBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::AltColor)];
-
-    CreateGeometry(MinHues, MinSaturations, WheelInnerRadius, 0.0f, 0.0f, colorWheelVerts);
     auto& vertexBuffer = vertexBufferObjects[static_cast<GLuint>(Vbo::Vertices)];
 
-    std::vector<GLint>      trackStartPositions(SaturationCountForTessellation(MaxSaturationTessellations));
-    std::vector<GLsizei>    trackIndiceCounts(SaturationCountForTessellation(MaxSaturationTessellations));
-    {
-        saturationBuffer.Bind();
-        ::glVertexAttribPointer(
-            SaturationLocation,
-            sizeof(colorWheelSaturation[0]) / sizeof(GLfloat),
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            nullptr
-            );
-        gl::VerifyNoErrors();
-
-        vertexBuffer.Bind();
-        ::glVertexAttribPointer(
-            PositionLocation,
-            sizeof(colorWheelVerts[0]) / sizeof(GLfloat),
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            nullptr
-            );
-        gl::VerifyNoErrors();
+    // Each attribute lives in its own tightly packed buffer object.
+    gl::VertexLayout wheelLayout;
+    wheelLayout
+        .Add<GLfloat>(SaturationLocation, saturationBuffer)
+        .Add<glm::vec2>(PositionLocation, vertexBuffer)
+        .Add<glm::vec3>(ColorLocation, colorBuffer)
+        .Add<glm::vec3>(AltColorLocation, altColorBuffer);
+    wheelLayout.Validate(*pShader);
 
-        colorBuffer.Bind();
-        ::glVertexAttribPointer(
-            ColorLocation,
-            sizeof(colorWheelColors[0]) / sizeof(GLfloat),
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            nullptr
-            );
-        gl::VerifyNoErrors();
+    gl::VertexArray wheelVertexArray;
+    wheelVertexArray.SetLayout(wheelLayout);
 
-        altColorBuffer.Bind();
-        ::glVertexAttribPointer(
-            AltColorLocation,
-            sizeof(altColorWheelColors[0]) / sizeof(GLfloat),
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            nullptr
-            );
-        gl::VerifyNoErrors();
-
-        // Enable the vertex attribute buffers for use with OpenGL drawing commands.
-        ::glEnableVertexAttribArray(SaturationLocation);
-        gl::VerifyNoErrors();
-
-        ::glEnableVertexAttribArray(PositionLocation);
-        gl::VerifyNoErrors();
-
-        ::glEnableVertexAttribArray(ColorLocation);
-        gl::VerifyNoErrors();
-
-        ::glEnableVertexAttribArray(AltColorLocation);
-        gl::VerifyNoErrors();
+    // A core profile program only validates with a vertex array bound; SetLayout() left it bound.
+    {
+        std::cout << "Validating complete shader program: ";
+        pShader->Validate();
+        std::cout << (pShader->IsValid() ? "SUCCESS" : "FAILED") << std::endl;
+        std::cout << pShader->GetLinkerOrValidationOutput() << std::endl << std::endl;
     }
 
-    InitializeGui();
+    InitializeGui(options.isSdfText, startup.fontFile.valid() ? startup.fontFile.get() : std::vector<unsigned char>());
+
+    // The wheel is rendered at the drawable's pixel resolution, which exceeds ScreenSize on HiDPI
+    // displays. NOTE: The projection is only set once at startup, so the cache never has to be
+    // resized or invalidated for it.
+    glm::ivec2 drawableSize;
+    ::SDL_GL_GetDrawableSize(windowHandle, &drawableSize.x, &drawableSize.y);
+    WheelCache wheelCache(drawableSize);
+    GuiCache guiCache(drawableSize, ScreenSize, static_cast<float>(drawableSize.x) / static_cast<float>(ScreenSize.x));
+
+    Renderer renderer;
+    renderer.pShader = pShader.get();
+    renderer.pWheelVertexArray = &wheelVertexArray;
+    renderer.pWheelCache = &wheelCache;
+    renderer.pGuiCache = &guiCache;
+    renderer.pTimings = &frameTimings;
+    renderer.pWindowHandle = &windowHandle;
+    renderer.initialModelViewMatrix = modelViewMatrix;
+    renderer.hasUploadedUniforms = false;
+    renderer.isLatencyFenced = options.isLatencyFenced;
+    renderer.measuredInputTicks = renderer.lastMeasuredInput.time_since_epoch().count();
+    renderer.issuedBinds = 0u;
+    renderer.elidedBinds = 0u;
+    renderer.frameAllocations = 0u;
+    renderer.totalAllocations = 0u;
+    renderer.firstFrameTicks = 0;
 
     // GUI state
     glm::ivec2 mouseCursor;
@@ -616,52 +728,196 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
     auto isGeometryCylinder = true;
     // GUI state
 
-    auto prev_ticks = ::SDL_GetTicks();
     auto x = 100.0f;
 
-    const auto VertexBlendRate = 0.005f;
+    // Animation rates, in units per millisecond.
+    const auto VertexBlendRate = 0.005f;
+    const auto InnerRadiusBlendRate = 0.005f;
+    const auto ColorBlendRate = 0.001f;
+    const auto ColorSpaceBlendRate = InnerRadiusBlendRate;
+    const auto ConeScaleRate = InnerRadiusBlendRate / 4.0f;
+
+    Animator animator;
+    animator.Set(AnimationChannel::InnerRadius, 1.0f);
+    animator.Set(AnimationChannel::SectorBlend, static_cast<float>(static_cast<int>(colorCountPower)));
+    animator.Set(AnimationChannel::TrackBlend, static_cast<float>(static_cast<int>(saturationCountPower)));
+    animator.Set(AnimationChannel::ConeScale, 1.0f);
+
+    // The mesh as last generated, from the sector and track levels.
+    WheelMesh mesh;
+    MeshPools meshPools;
+    auto currentColorCountPower = static_cast<int>(colorCountPower);
+    auto sectorBlendT = 1.0f;
+    auto currentSaturationCountPower = static_cast<int>(saturationCountPower);
+    auto trackBlendT = 1.0f;
+    auto isTopologyStale = true;    // The sector or track count changed; rebuild everything.
+
+    auto currentColorSpace = colorSpace;
+    auto nextColorSpace = colorSpace;
+
+    auto hsLightness = 0.5f;
+    auto hsValue = 1.0f;
+
+    auto coneScale = 1.0f;
+    auto isUserScalingCone = false;
+
+    // Set COLORWHEEL_TRACE=<file> to trace from startup until exit; or, press F2 to start and stop
+    // a capture into trace.json.
+    TRACE_THREAD_NAME("main");
+    const char* const TraceFromStartupPath = std::getenv("COLORWHEEL_TRACE");
+    if (nullptr != TraceFromStartupPath)
+    {
+        trace::StartCapture();
+    }
+
+    // Input comes from SDL, or from a session recording. Either way, it can also be recorded.
+    std::unique_ptr<session::Recorder> pRecorder;
+    if (!options.recordPath.empty())
+    {
+        pRecorder.reset(new session::Recorder(options.recordPath));
+    }
+
+    std::unique_ptr<session::Player> pPlayer;
+    if (!options.replayPath.empty())
+    {
+        pPlayer.reset(new session::Player(options.replayPath));
+    }
+
+    std::vector<SDL_Event> frameEvents;
+    std::vector<SDL_Event> replayEvents;
+    frameEvents.reserve(256u);
+    replayEvents.reserve(256u);
+    const auto RunStart = FrameTimings::clock::now();
+
+    // A static scene isn't redrawn; replays and --fast runs draw every frame as fast as they can.
+    RedrawScheduler redrawScheduler(nullptr == pPlayer && !options.isFast);
+
+    // Frames are drawn on a dedicated thread that owns the GL context, unless --single-thread is
+    // given. The loop handles input, animation, and the GUI, then publishes a FramePacket.
+    FramePacket singleThreadPacket;
+    std::unique_ptr<RenderThread> pRenderThread;
+    if (!options.isSingleThreaded)
+    {
+        pRenderThread.reset(new RenderThread(
+            windowHandle,
+            context,
+            [&renderer](const FramePacket& packet) { RenderFrame(renderer, packet); }
+            ));
+    }
+
+    // Replays, and live frames paced by vsync, run in lockstep with the renderer: the loop waits for
+    // it to take each packet, so it builds no more frames than are swapped. With --fast, the loop
+    // waits at most this long before it polls input again, and the renderer draws the latest packet.
+    const std::chrono::milliseconds MaxRendererWait(4);
+    const auto isRendererLockstep = nullptr != pPlayer || redrawScheduler.IsEnabled();
+    std::uint64_t frameNumber = 0u;
+
+    // When each input event that hasn't been measured as drawn yet happened, oldest first.
+    std::vector<FrameTimings::clock::time_point> pendingInputTimes;
+    pendingInputTimes.reserve(FramePacket::InputTimeCapacity);
+
+    // Once warmed up (every FramePacket has been filled once), neither thread should allocate;
+    // except to grow the mesh pools the first time a larger mesh is generated.
+    const std::uint64_t ZeroAllocationWarmupFrames = 3u;
+    std::uint64_t lastFrameAllocations = 0u;
+    std::uint64_t steadyAllocations = 0u;
+    std::uint64_t renderAllocationsAtWarmup = 0u;
+    std::uint64_t meshGrowthFrames = 0u;
+
+    bool done = false;
+    while (!done)
+    {
+        frameEvents.clear();
+
+        // Sleep until there's input, while nothing needs to be drawn.
+        if (!redrawScheduler.IsRedrawDue())
+        {
+            const auto idleStart = FrameTimings::clock::now();
+            SDL_Event idleEvent;
+            const auto hasEvent = redrawScheduler.WaitForEvent(idleEvent);
+            frameTimings.ExcludeIdleTime(FrameTimings::clock::now() - idleStart);
+            if (!hasEvent)
+            {
+                continue;
+            }
+            frameEvents.push_back(idleEvent);
+        }
+
+        frameTimings.BeginFrame();
+        const alloc_tracker::Scope frameAllocationScope;
+        const auto frameGrowthCount = meshPools.GrowthCount();
+        if (trace::IsCapturing())
+        {
+            trace::Collect();
+        }
+        TRACE_SCOPE("Frame");
 
-    auto currentColorCountPower = static_cast<int>(colorCountPower);
-    auto sectorBlendT = 1.0f;
-    auto sectorBlendVelocity = 0.0f;
+        // Milliseconds, at the resolution of the steady clock rather than SDL_GetTicks().
+        auto delta_t = frameTimings.LastFrameMilliseconds();
 
-    auto currentSaturationCountPower = static_cast<int>(saturationCountPower);
-    auto trackBlendT = 0.0f;
-    auto trackBlendVelocity = 0.0f;
+        // input
+        TRACE_SPAN(inputSpan, "Input polling");
+        SDL_Event polledEvent;
+        while (::SDL_PollEvent(&polledEvent))
+        {
+            // Live input is ignored during a replay; except to cancel it.
+            if (nullptr == pPlayer ||
+                (SDL_KEYDOWN == polledEvent.type && SDL_SCANCODE_ESCAPE == polledEvent.key.keysym.scancode))
+            {
+                frameEvents.push_back(polledEvent);
+            }
+        }
 
-    const auto InnerRadiusBlendRate = 0.005f;
-    auto innerRadiusBlendDirection = 0.0f;
-    auto innerRadiusBlendT = 1.0f;
-    auto currentInnerRadius = innerRadiusBlendT * WheelInnerRadius;
+        if (nullptr != pPlayer)
+        {
+            if (pPlayer->ReadFrame(delta_t, replayEvents))
+            {
+                frameEvents.insert(frameEvents.end(), replayEvents.begin(), replayEvents.end());
+            }
+            else
+            {
+                done = true;
+            }
+        }
 
-    const auto ColorBlendRate = 0.001f;
-    auto colorBlendDirection = 0.0f;
-    auto colorBlendT = 0.0f;
-    
-    const auto ColorSpaceBlendRate = InnerRadiusBlendRate;
-    auto colorSpaceBlendDirection = 0.0f;
-    auto colorSpaceBlendT = 0.0f;
+        if (0.0 < options.fixedStep)
+        {
+            delta_t = options.fixedStep;
+        }
 
-    auto currentColorSpace = colorSpace;
-    auto nextColorSpace = colorSpace;
+        if (!frameEvents.empty())
+        {
+            redrawScheduler.RequestRedraw();
+        }
 
-    auto hsLightness = 0.5f;
-    auto hsValue = 1.0f;
+        // SDL timestamps events in SDL_GetTicks() milliseconds; the renderer measures their latency
+        // on the steady clock.
+        {
+            const auto pollTime = FrameTimings::clock::now();
+            const auto pollTicks = ::SDL_GetTicks();
+            for (const auto& event : frameEvents)
+            {
+                if (!session::IsRecorded(event))
+                {
+                    continue;
+                }
 
-    const auto ConeScaleRate = InnerRadiusBlendRate / 4.0f;
-    auto coneScaleDirection = 0.0f;
-    auto coneScale = 1.0f;
-    auto currentConeScale = 1.0f;
-    auto isUserScalingCone = false;
+                auto eventTime = pollTime - std::chrono::milliseconds(pollTicks - event.common.timestamp);
+                if (!pendingInputTimes.empty())
+                {
+                    // The clocks aren't in phase; keep the times in order.
+                    eventTime = std::max(eventTime, pendingInputTimes.back());
+                }
+                pendingInputTimes.push_back(eventTime);
+            }
+        }
 
-    auto isMorphing = true;
+        if (nullptr != pRecorder)
+        {
+            pRecorder->WriteFrame(delta_t, frameEvents);
+        }
 
-    bool done = false;
-    while (!done)
-    {
-        // input
-        SDL_Event event;
-        while (::SDL_PollEvent(&event))
+        for (const auto& event : frameEvents)
         {
             if (SDL_KEYDOWN == event.type)
             {
@@ -669,6 +925,26 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
                 {
                     done = true;
                 }
+                else if (event.key.keysym.scancode == SDL_SCANCODE_F1)
+                {
+                    frameTimings.ToggleOverlay();
+                }
+                else if (event.key.keysym.scancode == SDL_SCANCODE_F2)
+                {
+                    if (!trace::IsCapturing())
+                    {
+                        std::cout << "Trace capture started." << std::endl;
+                        trace::StartCapture();
+                    }
+                    else if (trace::StopCapture("trace.json"))
+                    {
+                        std::cout << "Trace capture written to: trace.json" << std::endl;
+                    }
+                    else
+                    {
+                        std::cerr << "Failed to write trace capture: trace.json" << std::endl;
+                    }
+                }
             }
 
             else if (SDL_MOUSEMOTION == event.type)
@@ -700,266 +976,155 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
                 mouseWheel.y = event.wheel.y;
             }
         }
+        TRACE_SPAN_END(inputSpan);
 
-        double delta_t = 0;
-        {
-            auto current_ticks = ::SDL_GetTicks();
-            delta_t = current_ticks - prev_ticks;
-            prev_ticks = current_ticks;
-        }
+        auto& packet = (nullptr != pRenderThread) ? pRenderThread->NextPacket() : singleThreadPacket;
+        packet.number = ++frameNumber;
 
-        // transform
-        // collisions
+        // Events stop being passed along once a frame showing them has been measured.
+        const FrameTimings::clock::time_point measuredInput(
+            FrameTimings::clock::duration(renderer.measuredInputTicks.load())
+            );
+        pendingInputTimes.erase(
+            pendingInputTimes.begin(),
+            std::upper_bound(pendingInputTimes.begin(), pendingInputTimes.end(), measuredInput)
+            );
+        packet.inputTimes = pendingInputTimes;
 
-        // render
+        // animation
         {
-            ::glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
-            ::glClear(GL_COLOR_BUFFER_BIT); // GL_DEPTH_BUFFER_BIT |
-
-            ::glBindVertexArray(vertexArrayObjectName);
-            gl::VerifyNoErrors();
-            {
-                pShader->Use();
-
-                if (0.0f != colorBlendDirection) // if (animating a color change)
-                {
-                    colorBlendT += delta_t * colorBlendDirection;
-
-                    if (colorBlendT <= 0.0f || colorBlendT >= 1.0f)
-                    {
-                        colorBlendDirection = 0.0f;
-                    }
-
-                    colorBlendT = Clamp(colorBlendT, 0.0f, 1.0f);
-
-                    pShader->SetUniform(colorBlendTLocation, colorBlendT);
-                    gl::VerifyNoErrors();
-                }
-
-                if (colorSpace != currentColorSpace || 0.0f != colorSpaceBlendDirection)
-                {
-                    if (0.0f == colorSpaceBlendT)
-                    {
-                        nextColorSpace = colorSpace;
-                    }
-
-                    colorSpaceBlendDirection = ColorSpaceBlendRate;
-
-                    colorSpaceBlendT += delta_t * colorSpaceBlendDirection;
-                    colorSpaceBlendT = Clamp(colorSpaceBlendT, 0.0f, 1.0f);
-
-                    if (colorSpaceBlendT >= 1.0f)
-                    {
-                        currentColorSpace = nextColorSpace;
-                        colorSpaceBlendDirection = 0.0f;
-                        colorSpaceBlendT = 0.0f;
-
-                        pShader->SetUniform(colorSpace0Location, static_cast<GLint>(currentColorSpace));
-                        gl::VerifyNoErrors();
-                    }
-                    else
-                    {
-                        pShader->SetUniform(colorSpace0Location, static_cast<GLint>(currentColorSpace));
-                        gl::VerifyNoErrors();
-
-                        pShader->SetUniform(colorSpace1Location, static_cast<GLint>(nextColorSpace));
-                        gl::VerifyNoErrors();
-                    }
-
-                    pShader->SetUniform(colorSpaceBlendTLocation, colorSpaceBlendT);
-                    gl::VerifyNoErrors();
-                }
-
-                if (0.0f != innerRadiusBlendDirection)
-                {
-                    innerRadiusBlendT += delta_t * innerRadiusBlendDirection;
-
-                    if (innerRadiusBlendT <= 0.0f || innerRadiusBlendT >= 1.0f)
-                    {
-                        innerRadiusBlendDirection = 0.0f;
-                    }
-
-                    innerRadiusBlendT = Clamp(innerRadiusBlendT, 0.0f, 1.0f);
-
-                    currentInnerRadius = innerRadiusBlendT * WheelInnerRadius;
-                    isMorphing = true;
-                }
+            TRACE_SPAN(animationSpan, "Animation update");
 
-                // if (animating color count change)
-                const auto GuiColorCountPower = static_cast<int>(colorCountPower);
+            // Point the tweens at what the GUI asked for last frame.
+            animator.AnimateTo(
+                AnimationChannel::SectorBlend,
+                static_cast<float>(static_cast<int>(colorCountPower)),
+                VertexBlendRate
+                );
+            animator.AnimateTo(
+                AnimationChannel::TrackBlend,
+                static_cast<float>(static_cast<int>(saturationCountPower)),
+                VertexBlendRate
+                );
 
-                // if (the current number of colors doesn't match the GUI setting OR
-                //      the geometry is still animating into place)
-                if (GuiColorCountPower != currentColorCountPower || 0.0f != sectorBlendVelocity)
-                {
-                    if (GuiColorCountPower >= currentColorCountPower)
-                    {
-                        sectorBlendVelocity = VertexBlendRate;
-                    }
-                    else if (GuiColorCountPower < currentColorCountPower)
-                    {
-                        sectorBlendVelocity = -VertexBlendRate;
-                    }
+            // A color space blend runs to completion before the next one starts.
+            if (colorSpace != currentColorSpace &&
+                !animator.IsAnimating(AnimationChannel::ColorSpaceBlend))
+            {
+                nextColorSpace = colorSpace;
+                animator.AnimateTo(AnimationChannel::ColorSpaceBlend, 1.0f, ColorSpaceBlendRate);
+            }
 
-                    sectorBlendT += delta_t * sectorBlendVelocity;
+            if (colorSpace == ColorSpace::ColorWheel || isGeometryCylinder)
+            {
+                coneScale = 1.0f;
+            }
+            else if (colorSpace == ColorSpace::Hsl)
+            {
+                coneScale = 1.0f - std::abs(hsLightness * 2.0f - 1.0f);
+            }
+            else // colorSpace == ColorSpace::Hsv
+            {
+                coneScale = hsValue;
+            }
 
-                    if (sectorBlendT <= 0.0f)
-                    {
-                        --currentColorCountPower;
-                        sectorBlendT = 1.0f;
+            // The cone eases into a new shape, then follows the lightness / value slider directly.
+            if (isUserScalingCone)
+            {
+                animator.Set(AnimationChannel::ConeScale, coneScale);
+            }
+            else
+            {
+                animator.AnimateTo(AnimationChannel::ConeScale, coneScale, ConeScaleRate);
+            }
 
-                        if (GuiColorCountPower == currentColorCountPower)
-                        {
-                            sectorBlendVelocity = 0.0f;
-                        }
-                    }
-                    else if (sectorBlendT >= 1.0f)
-                    {
-                        if (GuiColorCountPower == currentColorCountPower)
-                        {
-                            sectorBlendT = 1.0f;
-                            sectorBlendVelocity = 0.0f;
-                        }
-                        else
-                        {
-                            ++currentColorCountPower;
-                            sectorBlendT = 0.0f;
-                        }
-                    }
+            animator.Advance(delta_t);
 
-                    isMorphing = true;
-                }
+            if (!animator.IsAnimating(AnimationChannel::ConeScale))
+            {
+                isUserScalingCone = true;
+            }
 
-                // if (animating saturation count change)
-                const auto GuiSaturationCountPower = static_cast<int>(saturationCountPower);
+            if (animator.HasFinished(AnimationChannel::ColorSpaceBlend))
+            {
+                currentColorSpace = nextColorSpace;
+                animator.Set(AnimationChannel::ColorSpaceBlend, 0.0f);
+            }
 
-                // if (the current number of colors doesn't match the GUI setting OR
-                //      the geometry is still animating into place)
-                if (GuiSaturationCountPower != currentSaturationCountPower || 0.0f != trackBlendVelocity)
-                {
-                    if (GuiSaturationCountPower >= currentSaturationCountPower)
-                    {
-                        trackBlendVelocity = VertexBlendRate;
-                    }
-                    else if (GuiSaturationCountPower < currentSaturationCountPower)
-                    {
-                        trackBlendVelocity = -VertexBlendRate;
-                    }
+            // The renderer only uploads the uniforms that differ from what it last sent.
+            packet.uniforms = WheelUniforms {
+                animator.Value(AnimationChannel::ColorBlend),
+                static_cast<GLint>(currentColorSpace),
+                static_cast<GLint>(nextColorSpace),
+                animator.Value(AnimationChannel::ColorSpaceBlend),
+                hsLightness,
+                hsValue,
+                animator.Value(AnimationChannel::ConeScale)
+            };
+
+            // Only regenerate the parts of the mesh that depend on the channels that changed.
+            const auto isSectorChanged = animator.HasChanged(AnimationChannel::SectorBlend);
+            if (isSectorChanged)
+            {
+                auto power = 0;
+                SplitLevel(animator.Value(AnimationChannel::SectorBlend), power, sectorBlendT);
+                isTopologyStale = isTopologyStale || power != currentColorCountPower;
+                currentColorCountPower = power;
+            }
 
-                    trackBlendT += delta_t * trackBlendVelocity;
+            const auto isTrackChanged = animator.HasChanged(AnimationChannel::TrackBlend);
+            if (isTrackChanged)
+            {
+                auto power = 0;
+                SplitLevel(animator.Value(AnimationChannel::TrackBlend), power, trackBlendT);
+                isTopologyStale = isTopologyStale || power != currentSaturationCountPower;
+                currentSaturationCountPower = power;
+            }
 
-                    if (trackBlendT <= 0.0f)
-                    {
-                        --currentSaturationCountPower;
-                        trackBlendT = 1.0f;
+            const auto isSaturationStale = isTopologyStale || isTrackChanged;
+            const auto isGeometryStale = isSaturationStale || isSectorChanged ||
+                animator.HasChanged(AnimationChannel::InnerRadius);
 
-                        if (GuiSaturationCountPower == currentSaturationCountPower)
-                        {
-                            trackBlendVelocity = 0.0f;
-                        }
-                    }
-                    else if (trackBlendT >= 1.0f)
-                    {
-                        if (GuiSaturationCountPower == currentSaturationCountPower)
-                        {
-                            trackBlendT = 1.0f;
-                            trackBlendVelocity = 0.0f;
-                        }
-                        else
-                        {
-                            ++currentSaturationCountPower;
-                            trackBlendT = 0.0f;
-                        }
-                    }
+            animator.ClearChanges();
+            TRACE_SPAN_END(animationSpan);
 
-                    isMorphing = true;
-                }
+            if (isGeometryStale)
+            {
+                TRACE_SCOPE("Mesh regeneration");
 
-                pShader->SetUniform(lightnessLocation, hsLightness);
-                gl::VerifyNoErrors();
-                pShader->SetUniform(valueLocation, hsValue);
-                gl::VerifyNoErrors();
+                const auto ColorCount = ColorCountForTessellation(currentColorCountPower);
+                const auto TrackCount = SaturationCountForTessellation(currentSaturationCountPower);
 
+                if (isTopologyStale)
                 {
-                    if (colorSpace == ColorSpace::ColorWheel || isGeometryCylinder)
-                    {
-                        coneScale = 1.0f;
-                    }
-                    else if (colorSpace == ColorSpace::Hsl)
-                    {
-                        coneScale = 1.0f - std::abs(hsLightness * 2.0f - 1.0f);
-                    }
-                    else // colorSpace == ColorSpace::Hsv
-                    {
-                        coneScale = hsValue;
-                    }
-
-                    if (isUserScalingCone)
-                    {
-                        currentConeScale = coneScale;
-                    }
-                    else
-                    {
-                        if (currentConeScale < coneScale)
-                        {
-                            coneScaleDirection = ConeScaleRate;
-                        }
-                        else if (currentConeScale > coneScale)
-                        {
-                            coneScaleDirection = -ConeScaleRate;
-                        }
-
-                        if (delta_t * coneScaleDirection >= std::abs(coneScale - currentConeScale))
-                        {
-                            coneScaleDirection = 0.0f;
-                            currentConeScale = coneScale;
-                            isUserScalingCone = true;
-                        }
-                        else
-                        {
-                            currentConeScale += delta_t * coneScaleDirection;
-                        }
-                    }
-
-                    if (1.0f == currentConeScale)
-                    {
-                        pShader->SetUniform(modelViewMatrixLocation, InitialModelViewMatrix);
-                    }
-                    else
-                    {
-                        modelViewMatrix = glm::scale(InitialModelViewMatrix, glm::vec3(currentConeScale));
-                        pShader->SetUniform(modelViewMatrixLocation, modelViewMatrix);
-                    }
+                    CreateIndices(ColorCount, TrackCount, mesh, meshPools);
+                    CreateColors(ColorCount, TrackCount, mesh, meshPools, frameTimings);
+                    isTopologyStale = false;
                 }
-
-                const auto TrackCount = SaturationCountForTessellation(currentSaturationCountPower);
-
-                if (isMorphing)
+                if (isSaturationStale)
                 {
-                    const auto ColorCount = ColorCountForTessellation(currentColorCountPower);
-
-                    RecalculateIndices(ColorCount, TrackCount, trackStartPositions, trackIndiceCounts);
-                    CreateColors(ColorCount, TrackCount, colorWheelColors, altColorWheelColors);
-                    CreateSaturation(ColorCount, TrackCount, trackBlendT, colorWheelSaturation);
-                    CreateGeometry(
-                        ColorCount,
-                        TrackCount,
-                        currentInnerRadius,
-                        sectorBlendT,
-                        trackBlendT,
-                        colorWheelVerts
-                        );
-                    isMorphing = false;
+                    CreateSaturation(ColorCount, TrackCount, trackBlendT, mesh, meshPools, frameTimings);
                 }
-
-                DrawColorWheel(TrackCount, trackStartPositions, trackIndiceCounts);
+                CreateGeometry(
+                    ColorCount,
+                    TrackCount,
+                    animator.Value(AnimationChannel::InnerRadius) * WheelInnerRadius,
+                    sectorBlendT,
+                    trackBlendT,
+                    mesh,
+                    meshPools,
+                    frameTimings
+                    );
             }
-            ::glBindVertexArray(0);
-            gl::VerifyNoErrors();
 
+            packet.mesh = mesh;
+        }
 
-            // Draw GUI
-            ///////////
+        // Build the GUI
+        ////////////////
+        {
+            const auto guiStart = FrameTimings::clock::now();
+            TRACE_SPAN(guiBuildSpan, "imgui command building");
 
             // Pass input to GUI
             ::imguiBeginFrame(
@@ -997,8 +1162,11 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
                         }
                         if (original != colorModel)
                         {
-                            colorBlendDirection = ColorModel::Ryb == colorModel ?
-                                ColorBlendRate : -ColorBlendRate;
+                            animator.AnimateTo(
+                                AnimationChannel::ColorBlend,
+                                ColorModel::Ryb == colorModel ? 1.0f : 0.0f,
+                                ColorBlendRate
+                                );
                         }
                     }
 
@@ -1008,11 +1176,15 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
 
                     {
                         // 6, 12, 24, 48, 96, 192, 384
-                        std::ostringstream os;
-                        os << "Sectors: " <<
-                            ColorCountForTessellation(static_cast<int>(colorCountPower));
+                        char label[32];
+                        std::snprintf(
+                            label,
+                            sizeof(label),
+                            "Sectors: %d",
+                            ColorCountForTessellation(static_cast<int>(colorCountPower))
+                            );
                         ::imguiSlider(
-                            os.str().c_str(),
+                            label,
                             &colorCountPower,
                             0,
                             MaxHueTessellations,
@@ -1026,11 +1198,15 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
 
                     {
                         // 2, 4, 8, 16, 32, 64, 128, 256, 512
-                        std::ostringstream os;
-                        os << "Tracks: " <<
-                            SaturationCountForTessellation(static_cast<int>(saturationCountPower));
+                        char label[32];
+                        std::snprintf(
+                            label,
+                            sizeof(label),
+                            "Tracks: %d",
+                            SaturationCountForTessellation(static_cast<int>(saturationCountPower))
+                            );
                         ::imguiSlider(
-                            os.str().c_str(),
+                            label,
                             &saturationCountPower,
                             -1,
                             MaxSaturationTessellations,
@@ -1056,7 +1232,7 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
                             
                             if (static_cast<ColorSpace>(next) == ColorSpace::ColorWheel)
                             {
-                                innerRadiusBlendDirection = InnerRadiusBlendRate;
+                                animator.AnimateTo(AnimationChannel::InnerRadius, 1.0f, InnerRadiusBlendRate);
                             }
                         }
                         else if (ColorSpace::Hsv == colorSpace)
@@ -1069,7 +1245,7 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
 
                             if (static_cast<ColorSpace>(next) == ColorSpace::ColorWheel)
                             {
-                                innerRadiusBlendDirection = InnerRadiusBlendRate;
+                                animator.AnimateTo(AnimationChannel::InnerRadius, 1.0f, InnerRadiusBlendRate);
                             }
                         }
                         else // (ColorSpace::ColorWheel == colorSpace)
@@ -1083,7 +1259,7 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
 
                             if (static_cast<ColorSpace>(next) != ColorSpace::Undefined)
                             {
-                                innerRadiusBlendDirection = -InnerRadiusBlendRate;
+                                animator.AnimateTo(AnimationChannel::InnerRadius, 0.0f, InnerRadiusBlendRate);
                             }
                         }
 
@@ -1147,43 +1323,181 @@ void RunGameLoop(const sdl::WindowHandle& windowHandle)
             }
             ::imguiEndFrame();
 
-//            ::imguiDrawText(
-//                20 + ScreenSize.x / 5,
-//                ScreenSize.y - 20,
-//                IMGUI_ALIGN_LEFT,
-//                "Free text",
-//                imguiRGBA(32,192, 32,192)
-//                );
+            {
+                char text[128];
+                std::snprintf(
+                    text,
+                    sizeof(text),
+                    "GL binds issued: %u  elided: %u   Heap allocations: %llu main  %llu render",
+                    static_cast<unsigned int>(renderer.issuedBinds.load(std::memory_order_relaxed)),
+                    static_cast<unsigned int>(renderer.elidedBinds.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(lastFrameAllocations),
+                    static_cast<unsigned long long>(renderer.frameAllocations.load(std::memory_order_relaxed))
+                    );
+                ::imguiDrawText(
+                    20 + ScreenSize.x / 5,
+                    ScreenSize.y - 20,
+                    IMGUI_ALIGN_LEFT,
+                    text,
+                    imguiRGBA(32,192, 32,192)
+                    );
+            }
 
-            ::imguiRenderGLDraw(ScreenSize.x, ScreenSize.y);
-            gl::VerifyNoErrors();
-        } // render commands
+            // Press F1 to show/hide.
+            frameTimings.DrawOverlay(20 + ScreenSize.x / 5, ScreenSize.y - 40);
+
+            packet.CopyGui(::imguiGetRenderQueue(), ::imguiGetRenderQueueSize());
+            TRACE_SPAN_END(guiBuildSpan);
+            frameTimings.AddCpuTime(FrameStage::Gui, FrameTimings::clock::now() - guiStart);
+        }
 
         x += static_cast<float>(delta_t / 100.0);
 
-        // swap buffers
-        ::SDL_GL_SwapWindow(windowHandle);
+        // Hand the frame to the renderer.
+        if (nullptr != pRenderThread)
+        {
+            pRenderThread->Publish();
+            if (isRendererLockstep)
+            {
+                while (!pRenderThread->WaitUntilTaken(std::chrono::milliseconds(100)))
+                {
+                }
+            }
+            else
+            {
+                pRenderThread->WaitUntilTaken(MaxRendererWait);
+            }
+        }
+        else
+        {
+            RenderFrame(renderer, packet);
+        }
+
+        // The timing overlay shows live numbers, so it keeps the loop drawing too.
+        redrawScheduler.FrameDrawn(animator.IsAnimating() || frameTimings.IsOverlayVisible());
+
+        // With --single-thread, the main thread's count includes drawing.
+        lastFrameAllocations = frameAllocationScope.Elapsed().allocations;
+        if (ZeroAllocationWarmupFrames == frameNumber)
+        {
+            renderAllocationsAtWarmup = renderer.totalAllocations.load(std::memory_order_relaxed);
+        }
+        else if (ZeroAllocationWarmupFrames < frameNumber)
+        {
+            if (meshPools.GrowthCount() != frameGrowthCount)
+            {
+                ++meshGrowthFrames;
+            }
+            else
+            {
+                steadyAllocations += lastFrameAllocations;
+            }
+        }
+    }
+
+    if (nullptr != pRenderThread)
+    {
+        pRenderThread->Stop();
+    }
+
+    if (nullptr != TraceFromStartupPath && trace::IsCapturing() &&
+        !trace::StopCapture(TraceFromStartupPath))
+    {
+        std::cerr << "Failed to write trace capture: " << TraceFromStartupPath << std::endl;
+    }
+
+    if (nullptr != pPlayer)
+    {
+        const auto elapsed = std::chrono::duration<double>(FrameTimings::clock::now() - RunStart).count();
+        std::cout << "Replayed " << pPlayer->FramesRead() << " frames of " << options.replayPath <<
+            " in " << elapsed << " s (" << pPlayer->FramesRead() / elapsed << " frames/s)." << std::endl;
+        std::cout << "Last " << TimingHistory::Capacity << " frames:" << std::endl;
+        frameTimings.WriteStatistics(std::cout);
+    }
+
+    if (nullptr != pRenderThread && 0u != pRenderThread->DroppedPackets())
+    {
+        std::cout << "Frames replaced before they were drawn: " << pRenderThread->DroppedPackets() << std::endl;
+    }
+
+    const auto firstFrameTicks = renderer.firstFrameTicks.load();
+    if (0 != firstFrameTicks)
+    {
+        typedef std::chrono::duration<double, std::milli> milliseconds;
+        const FrameTimings::clock::time_point firstFrame{FrameTimings::clock::duration(firstFrameTicks)};
+        std::cout << "Time to first frame: " << milliseconds(firstFrame - startup.launched).count() <<
+            " ms (window and OpenGL context ready at " <<
+            milliseconds(startup.contextCreated - startup.launched).count() << " ms)" << std::endl;
+    }
+
+    // Written for every run; replays make latency regressions comparable between builds.
+    frameTimings.WriteInputLatency(std::cout);
+
+    {
+        int guiCommands = 0;
+        int guiTextBytes = 0;
+        ::imguiGetRenderQueueHighWater(&guiCommands, &guiTextBytes);
+        std::cout << "GUI queue high-water mark: " << guiCommands << " commands, " << guiTextBytes <<
+            " bytes of text" << std::endl;
+    }
+
+    auto exitStatus = 0;
+    if (options.isZeroAllocationRequired)
+    {
+        if (nullptr != pRenderThread)
+        {
+            steadyAllocations += renderer.totalAllocations.load() - renderAllocationsAtWarmup;
+        }
 
-        // Slow the loop down... for now.
-//        ::usleep(1000 * 400);
+        std::cout << "Heap allocations after warm-up: " << steadyAllocations << " (excluding " <<
+            meshGrowthFrames << " frames that grew the mesh pools)" << std::endl;
+        if (0u != steadyAllocations)
+        {
+            std::cerr << "--require-zero-alloc: the replay allocated once warmed up." << std::endl;
+            exitStatus = 1;
+        }
     }
 
     ::imguiRenderGLDestroy();
+    return exitStatus;
 }
 
 
 // Initializes everything and starts running the game loop.
 int main(const int argc, const char* const argv[])
 {
-    (void)(argc); (void)(argv); // Unused parameters.
+    Startup startup;
+    startup.launched = FrameTimings::clock::now();
+
+    Options options;
+    try
+    {
+        options = ParseCommandLine(argc, argv);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl << Usage << std::endl;
+        return 1;
+    }
+
+    // Bitmap text starts from the prebaked glyphs, and only reads the font if one is missing; SDF
+    // text needs it right away, so it's read while SDL and OpenGL start. (The shaders are embedded.)
+    if (options.isSdfText)
+    {
+        startup.fontFile = std::async(std::launch::async, ReadBinaryFile, std::string(FontName));
+    }
 
     // Create some resources that will exist for the life of the application.
     auto pSdllibrary = InitializeApplication();
-    auto pWindow = CreateMainWindow(WindowName, ScreenSize);
+    auto pWindow = CreateMainWindow(WindowName, ScreenSize, options.isHeadless);
     auto pGlContext = CreateRenderingContext(*pWindow);
+    startup.contextCreated = FrameTimings::clock::now();
 
-    // OKGO!
-    RunGameLoop(*pWindow);
+    if (options.isFast)
+    {
+        ::SDL_GL_SetSwapInterval(0);
+    }
 
-    return 0;
+    // OKGO!
+    return RunGameLoop(*pWindow, *pGlContext, options, startup);
 }
@@ -0,0 +1,36 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <SDL2/SDL.h>
+
+#include "redraw_scheduler.hpp"
+
+
+RedrawScheduler::RedrawScheduler(const bool isEnabled) noexcept
+    : _isEnabled(isEnabled)
+    , _isAnimating(false)
+    , _pendingFrames(InputRedrawFrames)
+{
+    if (_isEnabled)
+    {
+        // Late swaps tear instead of dropping to half the refresh rate, where that's supported.
+        if (0 != ::SDL_GL_SetSwapInterval(-1))
+        {
+            ::SDL_GL_SetSwapInterval(1);
+        }
+    }
+}
+
+bool RedrawScheduler::WaitForEvent(SDL_Event& event) noexcept
+{
+    return 0 != ::SDL_WaitEventTimeout(&event, IdleTimeoutMilliseconds);
+}
+
+void RedrawScheduler::FrameDrawn(const bool isAnimating) noexcept
+{
+    _isAnimating = isAnimating;
+    if (0 < _pendingFrames)
+    {
+        --_pendingFrames;
+    }
+}
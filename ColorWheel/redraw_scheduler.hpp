@@ -0,0 +1,66 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef REDRAW_SCHEDULER
+#define REDRAW_SCHEDULER
+
+#include <SDL2/SDL.h>
+
+
+// Decides when the game loop has to draw a frame.
+//
+// While something is animating, every frame is drawn and paced by the swap interval (vsync).
+// Input redraws a couple of frames, so the GUI can react and settle. Otherwise the loop blocks in
+// SDL_WaitEventTimeout(), and neither the CPU nor the GPU does any work for a static scene.
+class RedrawScheduler
+{
+public:
+    // Frames drawn after any input; the GUI applies changes a frame after it sees the input.
+    static const int InputRedrawFrames = 2;
+
+    // The longest an idle wait blocks before the loop checks in again.
+    static const int IdleTimeoutMilliseconds = 500;
+
+    // A disabled scheduler redraws every frame and never blocks; for replays and benchmarks. An
+    // enabled one turns on vsync (adaptive, if the driver supports it) for the current context.
+    explicit RedrawScheduler(const bool isEnabled) noexcept;
+
+    bool IsEnabled() const noexcept
+    {
+        return _isEnabled;
+    }
+
+    // Returns: true, if the next loop iteration must draw a frame.
+    bool IsRedrawDue() const noexcept
+    {
+        return !_isEnabled || _isAnimating || 0 < _pendingFrames;
+    }
+
+    // Blocks until an event arrives, or the idle timeout elapses.
+    // Returns: true, if event was filled in.
+    bool WaitForEvent(SDL_Event& event) noexcept;
+
+    // Schedules frames to be drawn, even if nothing is animating.
+    void RequestRedraw(const int frameCount = InputRedrawFrames) noexcept
+    {
+        if (_pendingFrames < frameCount)
+        {
+            _pendingFrames = frameCount;
+        }
+    }
+
+    // Call once per drawn frame with whether any animation is still running.
+    void FrameDrawn(const bool isAnimating) noexcept;
+
+    // Not copyable.
+    RedrawScheduler(const RedrawScheduler&) = delete;
+    RedrawScheduler& operator =(const RedrawScheduler&) = delete;
+
+private:
+    const bool _isEnabled;
+    bool _isAnimating;
+    int _pendingFrames;
+};
+
+
+#endif
@@ -0,0 +1,148 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>           // Primary SDL include for all platforms.
+#include <opengl/gl3.h>         // Probably specific to OS X.
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>          // Vector and Matrix math.
+
+#include "sdl.hpp"
+#include "trace.hpp"
+#include "render_thread.hpp"
+
+
+RenderThread::RenderThread(const sdl::WindowHandle& windowHandle, const sdl::GlContext& context, render_function render)
+    : _windowHandle(windowHandle)
+    , _context(context)
+    , _render(std::move(render))
+    , _droppedCount(0u)
+    , _isStopping(false)
+    , _hasFailed(false)
+{
+    // A context can only be current on one thread at a time.
+    ::SDL_GL_MakeCurrent(_windowHandle, nullptr);
+    _thread = std::thread(&RenderThread::Run, this);
+}
+
+RenderThread::~RenderThread()
+{
+    try
+    {
+        Stop();
+    }
+    catch (...)
+    {
+        // Already shutting down.
+    }
+}
+
+void RenderThread::Publish()
+{
+    RethrowIfFailed();
+
+    if (_packets.Publish())
+    {
+        _droppedCount.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _packetPublished.notify_one();
+}
+
+bool RenderThread::WaitUntilTaken(const std::chrono::milliseconds timeout)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _packetTaken.wait_for(lock, timeout, [this]()
+        {
+            return !_packets.HasFresh() || _hasFailed.load();
+        });
+    }
+
+    RethrowIfFailed();
+    return !_packets.HasFresh();
+}
+
+void RenderThread::Stop()
+{
+    if (!_thread.joinable())
+    {
+        RethrowIfFailed();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _packetPublished.notify_one();
+    _thread.join();
+
+    ::SDL_GL_MakeCurrent(_windowHandle, _context);
+    RethrowIfFailed();
+}
+
+void RenderThread::RethrowIfFailed()
+{
+    if (!_hasFailed.load())
+    {
+        return;
+    }
+
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        failure = _failure;
+    }
+    std::rethrow_exception(failure);
+}
+
+void RenderThread::Run() noexcept
+{
+    try
+    {
+        TRACE_THREAD_NAME("render");
+
+        if (0 != ::SDL_GL_MakeCurrent(_windowHandle, _context))
+        {
+            throw std::runtime_error(std::string("SDL_GL_MakeCurrent failed: ") + ::SDL_GetError());
+        }
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _packetPublished.wait(lock, [this]()
+                {
+                    return _isStopping.load() || _packets.HasFresh();
+                });
+                if (_isStopping)
+                {
+                    break;
+                }
+            }
+
+            _packets.Acquire();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+            }
+            _packetTaken.notify_one();
+
+            _render(_packets.Front());
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _failure = std::current_exception();
+        _hasFailed = true;
+    }
+    _packetTaken.notify_one();
+
+    ::SDL_GL_MakeCurrent(_windowHandle, nullptr);
+}
@@ -0,0 +1,89 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef RENDER_THREAD
+#define RENDER_THREAD
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "triple_buffer.hpp"
+#include "frame_packet.hpp"
+
+
+// Dedicated rendering thread
+/////////////////////////////
+// Owns the OpenGL context while it runs, and draws the most recent FramePacket published by the
+// game loop. Packets are handed over through a lock-free triple buffer, so a slow swap or upload
+// never holds up input handling; a packet that's replaced before the renderer gets to it is
+// dropped. The mutex and condition variables are only used to sleep while there's nothing to do.
+class RenderThread
+{
+public:
+    // Draws (and swaps) one frame; called on the render thread.
+    typedef std::function<void(const FramePacket&)> render_function;
+
+    // Releases the context from the calling thread, and starts rendering on a new thread.
+    // Throws:  std::system_error : the thread couldn't be started.
+    RenderThread(const sdl::WindowHandle& windowHandle, const sdl::GlContext& context, render_function render);
+
+    // Stops the thread (ignoring any failure), and makes the context current on the calling thread.
+    virtual ~RenderThread();
+
+    // The packet to fill in before calling Publish(). Every field must be rewritten.
+    FramePacket& NextPacket() noexcept
+    {
+        return _packets.Back();
+    }
+
+    // Hands NextPacket() to the render thread.
+    void Publish();
+
+    // Blocks until the render thread has taken the last published packet, or timeout elapses.
+    // Returns: false, on timeout.
+    // Throws:  whatever the render thread threw, if it failed.
+    bool WaitUntilTaken(const std::chrono::milliseconds timeout);
+
+    // Finishes the frame being drawn, joins the thread, and makes the context current on the
+    // calling thread again.
+    // Throws:  whatever the render thread threw, if it failed.
+    void Stop();
+
+    // Throws:  whatever the render thread threw, if it failed.
+    void RethrowIfFailed();
+
+    std::uint64_t DroppedPackets() const noexcept
+    {
+        return _droppedCount.load(std::memory_order_relaxed);
+    }
+
+    // Not copyable.
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator =(const RenderThread&) = delete;
+
+private:
+    void Run() noexcept;
+
+    const sdl::WindowHandle& _windowHandle;
+    const sdl::GlContext& _context;
+    const render_function _render;
+
+    TripleBuffer<FramePacket> _packets;
+    std::atomic<std::uint64_t> _droppedCount;
+
+    std::mutex _mutex;
+    std::condition_variable _packetPublished;
+    std::condition_variable _packetTaken;
+    std::atomic<bool> _isStopping;
+    std::atomic<bool> _hasFailed;
+    std::exception_ptr _failure;    // Guarded by _mutex.
+
+    std::thread _thread;            // Last; it starts running in the constructor.
+};
+
+
+#endif
@@ -151,16 +151,18 @@ sdl::library_ptr InitializeApplication()
 }
 
 
-// Creates the main application window.
+// Creates the main application window. A hidden window still has a working OpenGL context; it's
+// used for headless replays.
 // Throws: SdlException
-sdl::window_ptr CreateMainWindow(const std::string& windowName, const glm::ivec2 windowSize)
+sdl::window_ptr CreateMainWindow(const std::string& windowName, const glm::ivec2 windowSize, const bool isHidden)
 {
     return sdl::window_ptr(new sdl::WindowHandle(
         windowName.c_str(),         // Title of the window.
         1400, 100,                  // Location to put the window on screen.
         windowSize.x, windowSize.y, // Size of the window.
         SDL_WINDOW_OPENGL |         // This window will be used for OpenGL rendering.
-        SDL_WINDOW_ALLOW_HIGHDPI    // Use retina resolution if available.
+        SDL_WINDOW_ALLOW_HIGHDPI |  // Use retina resolution if available.
+        (isHidden ? SDL_WINDOW_HIDDEN : 0)
         // SDL_WINDOW_SHOWN // NOTE: This is in every example, but I believe it is the default behavior.
         ));
 }
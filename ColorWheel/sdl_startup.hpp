@@ -7,7 +7,11 @@
 void ConfigureSdlOpenGLSettings() noexcept;
 void WriteOpenGLInfo() noexcept;
 sdl::library_ptr InitializeApplication();
-sdl::window_ptr CreateMainWindow(const std::string& windowName, const glm::ivec2 windowSize);
+sdl::window_ptr CreateMainWindow(
+    const std::string& windowName,
+    const glm::ivec2 windowSize,
+    const bool isHidden = false
+    );
 sdl::glcontext_ptr CreateRenderingContext(const sdl::WindowHandle& windowHandle);
 
 #endif
@@ -0,0 +1,272 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "session_recording.hpp"
+
+
+namespace session
+{
+
+namespace
+{
+
+    const char Magic[4] = { 'C', 'W', 'S', 'R' };
+    const std::size_t EventSize = 6u;
+
+    enum class EventKind
+        : std::uint8_t
+    {
+        KeyDown = 1,        // x: scancode
+        MouseMotion,        // detail: SDL_BUTTON_LMASK/RMASK state; x, y: position
+        MouseButton,        // detail: button, high bit set when pressed; x, y: position
+        MouseWheel          // x, y: scroll amount
+    };
+
+    const std::uint8_t PressedBit = 0x80u;
+
+    void Append(std::vector<std::uint8_t>& bytes, std::uint64_t value, const std::size_t size)
+    {
+        for (std::size_t i = 0u; i < size; ++i, value >>= 8)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(value & 0xFFu));
+        }
+    }
+
+    std::uint64_t Extract(const std::uint8_t* const bytes, const std::size_t size) noexcept
+    {
+        std::uint64_t value = 0u;
+        for (std::size_t i = size; i > 0u; --i)
+        {
+            value = (value << 8) | bytes[i - 1u];
+        }
+        return value;
+    }
+
+    std::int16_t Clamp16(const std::int32_t value) noexcept
+    {
+        if (value < std::numeric_limits<std::int16_t>::min())
+        {
+            return std::numeric_limits<std::int16_t>::min();
+        }
+        if (value > std::numeric_limits<std::int16_t>::max())
+        {
+            return std::numeric_limits<std::int16_t>::max();
+        }
+        return static_cast<std::int16_t>(value);
+    }
+
+    void AppendEvent(std::vector<std::uint8_t>& bytes, const EventKind kind, const std::uint8_t detail, const std::int32_t x, const std::int32_t y)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(kind));
+        bytes.push_back(detail);
+        Append(bytes, static_cast<std::uint16_t>(Clamp16(x)), 2u);
+        Append(bytes, static_cast<std::uint16_t>(Clamp16(y)), 2u);
+    }
+
+    // Throws:  std::runtime_error : the kind is unknown.
+    SDL_Event ToSdlEvent(const std::uint8_t* const bytes, const std::string& path)
+    {
+        const auto kind = static_cast<EventKind>(bytes[0]);
+        const auto detail = bytes[1];
+        const auto x = static_cast<std::int16_t>(Extract(bytes + 2, 2u));
+        const auto y = static_cast<std::int16_t>(Extract(bytes + 4, 2u));
+
+        SDL_Event event;
+        std::memset(&event, 0, sizeof(event));
+        switch (kind)
+        {
+            case EventKind::KeyDown:
+                event.type = SDL_KEYDOWN;
+                event.key.state = SDL_PRESSED;
+                event.key.keysym.scancode = static_cast<SDL_Scancode>(x);
+                break;
+
+            case EventKind::MouseMotion:
+                event.type = SDL_MOUSEMOTION;
+                event.motion.state = detail;
+                event.motion.x = x;
+                event.motion.y = y;
+                break;
+
+            case EventKind::MouseButton:
+                event.type = (0u != (detail & PressedBit)) ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                event.button.button = detail & ~PressedBit;
+                event.button.state = (0u != (detail & PressedBit)) ? SDL_PRESSED : SDL_RELEASED;
+                event.button.x = x;
+                event.button.y = y;
+                break;
+
+            case EventKind::MouseWheel:
+                event.type = SDL_MOUSEWHEEL;
+                event.wheel.x = x;
+                event.wheel.y = y;
+                break;
+
+            default:
+                throw std::runtime_error("corrupt session recording: " + path);
+        }
+        return event;
+    }
+
+} // namespace
+
+
+bool IsRecorded(const SDL_Event& event) noexcept
+{
+    switch (event.type)
+    {
+        case SDL_KEYDOWN:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+Recorder::Recorder(const std::string& path)
+    : _file(path, std::ios::binary | std::ios::trunc)
+{
+    if (!_file)
+    {
+        throw std::runtime_error("failed to create session recording: " + path);
+    }
+
+    std::vector<std::uint8_t> header(Magic, Magic + sizeof(Magic));
+    Append(header, FormatVersion, 4u);
+    _file.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+void Recorder::WriteFrame(const double deltaMilliseconds, const std::vector<SDL_Event>& events)
+{
+    _frame.clear();
+
+    std::uint64_t deltaBits;
+    static_assert(sizeof(deltaBits) == sizeof(deltaMilliseconds), "double must be 64-bit");
+    std::memcpy(&deltaBits, &deltaMilliseconds, sizeof(deltaBits));
+    Append(_frame, deltaBits, 8u);
+
+    const auto countOffset = _frame.size();
+    Append(_frame, 0u, 2u);
+
+    std::uint16_t count = 0u;
+    for (const auto& event : events)
+    {
+        if (!IsRecorded(event) || std::numeric_limits<std::uint16_t>::max() == count)
+        {
+            continue;
+        }
+
+        switch (event.type)
+        {
+            case SDL_KEYDOWN:
+                AppendEvent(_frame, EventKind::KeyDown, 0u, event.key.keysym.scancode, 0);
+                break;
+
+            case SDL_MOUSEMOTION:
+                AppendEvent(
+                    _frame,
+                    EventKind::MouseMotion,
+                    static_cast<std::uint8_t>(event.motion.state & (SDL_BUTTON_LMASK | SDL_BUTTON_RMASK)),
+                    event.motion.x,
+                    event.motion.y
+                    );
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                AppendEvent(
+                    _frame,
+                    EventKind::MouseButton,
+                    static_cast<std::uint8_t>((event.button.button & ~PressedBit) |
+                        (SDL_PRESSED == event.button.state ? PressedBit : 0u)),
+                    event.button.x,
+                    event.button.y
+                    );
+                break;
+
+            case SDL_MOUSEWHEEL:
+                AppendEvent(_frame, EventKind::MouseWheel, 0u, event.wheel.x, event.wheel.y);
+                break;
+        }
+        ++count;
+    }
+
+    _frame[countOffset] = static_cast<std::uint8_t>(count & 0xFFu);
+    _frame[countOffset + 1u] = static_cast<std::uint8_t>(count >> 8);
+
+    _file.write(reinterpret_cast<const char*>(_frame.data()), _frame.size());
+    if (!_file)
+    {
+        throw std::runtime_error("failed to write session recording");
+    }
+}
+
+
+Player::Player(const std::string& path)
+    : _file(path, std::ios::binary)
+    , _path(path)
+    , _framesRead(0u)
+{
+    if (!_file)
+    {
+        throw std::runtime_error("failed to open session recording: " + path);
+    }
+
+    std::uint8_t header[8];
+    _file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!_file || 0 != std::memcmp(header, Magic, sizeof(Magic)))
+    {
+        throw std::runtime_error("not a session recording: " + path);
+    }
+    if (FormatVersion != Extract(header + 4, 4u))
+    {
+        throw std::runtime_error("unsupported session recording version: " + path);
+    }
+}
+
+bool Player::ReadFrame(double& deltaMilliseconds, std::vector<SDL_Event>& events)
+{
+    events.clear();
+
+    std::uint8_t frameHeader[10];
+    _file.read(reinterpret_cast<char*>(frameHeader), sizeof(frameHeader));
+    if (0 == _file.gcount() && _file.eof())
+    {
+        return false;
+    }
+    if (!_file)
+    {
+        throw std::runtime_error("truncated session recording: " + _path);
+    }
+
+    const auto deltaBits = Extract(frameHeader, 8u);
+    std::memcpy(&deltaMilliseconds, &deltaBits, sizeof(deltaMilliseconds));
+
+    // Replayed events happen as they're read; input latency is measured from their timestamps.
+    const auto timestamp = ::SDL_GetTicks();
+    const auto count = static_cast<std::size_t>(Extract(frameHeader + 8, 2u));
+    for (std::size_t i = 0u; i < count; ++i)
+    {
+        std::uint8_t bytes[EventSize];
+        _file.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+        if (!_file)
+        {
+            throw std::runtime_error("truncated session recording: " + _path);
+        }
+        events.push_back(ToSdlEvent(bytes, _path));
+        events.back().common.timestamp = timestamp;
+    }
+
+    ++_framesRead;
+    return true;
+}
+
+} // namespace session
@@ -0,0 +1,83 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef SESSION_RECORDING
+#define SESSION_RECORDING
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+
+// Input session recording and replay
+/////////////////////////////////////
+// A session file is the sequence of frames the game loop ran: each frame's delta_t followed by the
+// input events polled during that frame. Replaying it feeds the loop exactly the same work, so frame
+// timings from different builds can be compared.
+//
+// Only the events the game loop reacts to (key downs, mouse motion, buttons, and the wheel) are
+// kept, and only the fields it reads. The format is little-endian regardless of the host:
+//
+//  header: "CWSR" u32 version
+//  frame:  f64 deltaMilliseconds, u16 eventCount, eventCount * (u8 kind, u8 detail, s16 x, s16 y)
+namespace session
+{
+
+    const std::uint32_t FormatVersion = 1u;
+
+    // Returns: true, if a recording would keep event.
+    bool IsRecorded(const SDL_Event& event) noexcept;
+
+    // Writes one frame of a session per call.
+    class Recorder
+    {
+    public:
+        // Throws:  std::runtime_error : the file couldn't be created.
+        explicit Recorder(const std::string& path);
+
+        // Appends a frame; events that aren't recorded are skipped.
+        // Throws:  std::runtime_error : writing failed.
+        void WriteFrame(const double deltaMilliseconds, const std::vector<SDL_Event>& events);
+
+        // Not copyable.
+        Recorder(const Recorder&) = delete;
+        Recorder& operator =(const Recorder&) = delete;
+
+    private:
+        std::ofstream _file;
+        std::vector<std::uint8_t> _frame;
+    };
+
+    // Reads back the frames of a session, in order.
+    class Player
+    {
+    public:
+        // Throws:  std::runtime_error : the file couldn't be opened, or isn't a session recording.
+        explicit Player(const std::string& path);
+
+        // Replaces events with the next frame's events, timestamped with the current SDL_GetTicks().
+        // Returns: false, at the end of the recording.
+        // Throws:  std::runtime_error : the file is truncated or corrupt.
+        bool ReadFrame(double& deltaMilliseconds, std::vector<SDL_Event>& events);
+
+        std::size_t FramesRead() const noexcept
+        {
+            return _framesRead;
+        }
+
+        // Not copyable.
+        Player(const Player&) = delete;
+        Player& operator =(const Player&) = delete;
+
+    private:
+        std::ifstream _file;
+        std::string _path;
+        std::size_t _framesRead;
+    };
+
+} // namespace session
+
+
+#endif
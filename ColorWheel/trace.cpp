@@ -0,0 +1,261 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "trace.hpp"
+
+
+namespace trace
+{
+
+namespace
+{
+
+    // Single-producer (the owning thread), single-consumer (Collect()) event ring.
+    class EventRing
+    {
+    public:
+        static const std::size_t Capacity = 1u << 15;    // A power of two.
+
+        EventRing(const std::uint32_t threadId)
+            : _head(0u)
+            , _tail(0u)
+            , _threadId(threadId)
+        {
+        }
+
+        // Producer only.
+        // Returns: false, if the ring is full and the event was dropped.
+        bool Push(const Event& event) noexcept
+        {
+            const auto head = _head.load(std::memory_order_relaxed);
+            if (head - _tail.load(std::memory_order_acquire) >= Capacity)
+            {
+                return false;
+            }
+
+            _events[head & (Capacity - 1u)] = event;
+            _head.store(head + 1u, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only.
+        template<typename function_t>
+        void Drain(function_t&& function)
+        {
+            const auto head = _head.load(std::memory_order_acquire);
+            auto tail = _tail.load(std::memory_order_relaxed);
+            for (; tail != head; ++tail)
+            {
+                function(_events[tail & (Capacity - 1u)]);
+            }
+            _tail.store(tail, std::memory_order_release);
+        }
+
+        std::uint32_t ThreadId() const noexcept
+        {
+            return _threadId;
+        }
+
+        // Not copyable.
+        EventRing(const EventRing&) = delete;
+        EventRing& operator =(const EventRing&) = delete;
+
+    private:
+        std::array<Event, Capacity> _events;
+        std::atomic<std::size_t> _head;
+        std::atomic<std::size_t> _tail;
+        const std::uint32_t _threadId;
+    };
+
+    struct CapturedEvent
+    {
+        Event           event;
+        std::uint32_t   threadId;
+    };
+
+    struct ThreadName
+    {
+        std::uint32_t   threadId;
+        std::string     name;
+    };
+
+    // Rings are never freed, so events recorded by threads that have exited can still be
+    // collected.
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<EventRing>> rings;
+    std::vector<ThreadName> threadNames;
+    std::vector<CapturedEvent> captured;
+    std::atomic<std::uint64_t> droppedCount(0u);
+
+    const clock::time_point epoch = clock::now();
+
+    EventRing& ThreadRing()
+    {
+        static thread_local EventRing* pRing = nullptr;
+        if (nullptr == pRing)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            rings.emplace_back(new EventRing(static_cast<std::uint32_t>(rings.size() + 1u)));
+            pRing = rings.back().get();
+        }
+        return *pRing;
+    }
+
+    // Writes name as a JSON string body.
+    void WriteEscaped(std::FILE* const file, const char* name)
+    {
+        for (; '\0' != *name; ++name)
+        {
+            if ('"' == *name || '\\' == *name)
+            {
+                std::fputc('\\', file);
+            }
+            std::fputc(*name, file);
+        }
+    }
+
+} // namespace
+
+
+namespace impl
+{
+
+    std::atomic<bool> isCapturing(false);
+
+    std::uint64_t Now() noexcept
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count()
+            );
+    }
+
+    void Record(const Event& event) noexcept
+    {
+        try
+        {
+            if (!ThreadRing().Push(event))
+            {
+                droppedCount.fetch_add(1u, std::memory_order_relaxed);
+            }
+        }
+        catch (...)
+        {
+            // Registering the thread's ring failed; the event is lost.
+            droppedCount.fetch_add(1u, std::memory_order_relaxed);
+        }
+    }
+
+} // namespace impl
+
+
+void StartCapture()
+{
+    impl::isCapturing.store(false, std::memory_order_relaxed);
+
+    // Throw away anything left from a previous capture.
+    Collect();
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        captured.clear();
+        captured.reserve(1u << 16);
+    }
+    droppedCount.store(0u, std::memory_order_relaxed);
+
+    impl::isCapturing.store(true, std::memory_order_relaxed);
+}
+
+void Collect()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& pRing : rings)
+    {
+        const auto threadId = pRing->ThreadId();
+        pRing->Drain([threadId](const Event& event)
+        {
+            captured.push_back(CapturedEvent { event, threadId });
+        });
+    }
+}
+
+bool StopCapture(const std::string& path)
+{
+    impl::isCapturing.store(false, std::memory_order_relaxed);
+    Collect();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::FILE* const file = std::fopen(path.c_str(), "w");
+    if (nullptr == file)
+    {
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    auto isFirst = true;
+    for (const auto& threadName : threadNames)
+    {
+        std::fprintf(
+            file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+            isFirst ? "" : ",\n",
+            static_cast<unsigned int>(threadName.threadId)
+            );
+        WriteEscaped(file, threadName.name.c_str());
+        std::fprintf(file, "\"}}");
+        isFirst = false;
+    }
+
+    for (const auto& captureEvent : captured)
+    {
+        std::fprintf(file, "%s{\"name\":\"", isFirst ? "" : ",\n");
+        WriteEscaped(file, captureEvent.event.name);
+        std::fprintf(
+            file,
+            "\",\"cat\":\"colorwheel\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            static_cast<unsigned int>(captureEvent.threadId),
+            captureEvent.event.startNs / 1000.0,
+            captureEvent.event.durationNs / 1000.0
+            );
+        isFirst = false;
+    }
+
+    std::fprintf(
+        file,
+        "\n],\"otherData\":{\"droppedEvents\":%llu}}\n",
+        static_cast<unsigned long long>(droppedCount.load(std::memory_order_relaxed))
+        );
+
+    const auto isWritten = 0 == std::ferror(file);
+    std::fclose(file);
+
+    captured.clear();
+    captured.shrink_to_fit();
+    return isWritten;
+}
+
+void SetThreadName(const char* const name)
+{
+    const auto threadId = ThreadRing().ThreadId();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& threadName : threadNames)
+    {
+        if (threadId == threadName.threadId)
+        {
+            threadName.name = name;
+            return;
+        }
+    }
+    threadNames.push_back(ThreadName { threadId, name });
+}
+
+} // namespace trace
@@ -0,0 +1,124 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Define COLORWHEEL_TRACING as 0 to compile every TRACE_* macro away entirely.
+#ifndef COLORWHEEL_TRACING
+#define COLORWHEEL_TRACING 1
+#endif
+
+
+// Chrome trace-event timeline capture
+//////////////////////////////////////
+// Spans are recorded as complete ("X") events into a lock-free single-producer/single-consumer ring
+// per thread, and written as a trace.json that about:tracing or Perfetto (ui.perfetto.dev) can
+// open. Nesting comes from the spans' time ranges, so scopes inside scopes show up nested.
+//
+// While no capture is running, a span costs one relaxed atomic load. Spans are either scoped
+// (TRACE_SCOPE), or named and ended explicitly (TRACE_SPAN, TRACE_SPAN_END).
+namespace trace
+{
+
+    typedef std::chrono::steady_clock clock;
+
+    // One completed span. name must be a string literal (or otherwise outlive the capture).
+    struct Event
+    {
+        const char*     name;
+        std::uint64_t   startNs;
+        std::uint64_t   durationNs;
+    };
+
+    namespace impl
+    {
+        extern std::atomic<bool> isCapturing;
+
+        // Returns: nanoseconds since the trace epoch.
+        std::uint64_t Now() noexcept;
+
+        // Appends to the calling thread's ring; the event is dropped if the ring is full.
+        void Record(const Event& event) noexcept;
+    }
+
+    // Starts recording spans from every thread; any previous capture is discarded.
+    // Throws:  std::bad_alloc
+    void StartCapture();
+
+    // Stops recording and writes everything captured to path.
+    // Returns: false, if the file couldn't be written.
+    bool StopCapture(const std::string& path);
+
+    inline bool IsCapturing() noexcept
+    {
+        return impl::isCapturing.load(std::memory_order_relaxed);
+    }
+
+    // Moves the events recorded so far out of the per-thread rings, so they can't overflow during
+    // long captures. Call once per frame from the thread that owns the capture.
+    // Throws:  std::bad_alloc
+    void Collect();
+
+    // Names the calling thread in the trace viewer.
+    // Throws:  std::bad_alloc
+    void SetThreadName(const char* name);
+
+    // Records the time between its construction and destruction (or End()) as a span.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* const name) noexcept
+            : _name(name)
+            , _startNs(IsCapturing() ? impl::Now() : 0u)
+        {
+        }
+
+        ~Scope()
+        {
+            End();
+        }
+
+        // Ends the span early; for spans that don't line up with a C++ scope.
+        void End() noexcept
+        {
+            if (0u != _startNs && IsCapturing())
+            {
+                impl::Record(Event { _name, _startNs, impl::Now() - _startNs });
+            }
+            _startNs = 0u;
+        }
+
+        // Not copyable.
+        Scope(const Scope&) = delete;
+        Scope& operator =(const Scope&) = delete;
+
+    private:
+        const char* const _name;
+        std::uint64_t _startNs;
+    };
+
+} // namespace trace
+
+
+#if COLORWHEEL_TRACING
+#define TRACE_CONCATENATE_IMPL(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_IMPL(a, b)
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+#define TRACE_SPAN(variable, name) ::trace::Scope variable(name)
+#define TRACE_SPAN_END(variable) variable.End()
+#define TRACE_THREAD_NAME(name) ::trace::SetThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SPAN(variable, name) ((void)0)
+#define TRACE_SPAN_END(variable) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+
+#endif
@@ -0,0 +1,87 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef TRIPLE_BUFFER
+#define TRIPLE_BUFFER
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+// Lock-free single-producer/single-consumer triple buffer.
+//
+// The producer fills Back() and publishes it; the consumer acquires the most recently published
+// slot and reads Front(). Neither side ever waits on the other: a slot published before the
+// consumer got to it is simply replaced (the latest value wins). Slots are reused, not
+// reconstructed, so their contents (and any capacity they've grown) carry over; the producer must
+// overwrite everything it publishes.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() noexcept
+        : _back(0u)
+        , _middle(1u)
+        , _front(2u)
+    {
+    }
+
+    // Producer only.
+    T& Back() noexcept
+    {
+        return _slots[_back];
+    }
+
+    // Producer only. Hands Back() to the consumer, and takes over a free slot as the next Back().
+    // Returns: true, if the previously published slot was replaced before the consumer acquired it.
+    bool Publish() noexcept
+    {
+        const auto previous = _middle.exchange(_back | FreshBit, std::memory_order_acq_rel);
+        _back = previous & IndexMask;
+        return 0u != (previous & FreshBit);
+    }
+
+    // Either side.
+    // Returns: true, if a slot was published and hasn't been acquired yet.
+    bool HasFresh() const noexcept
+    {
+        return 0u != (_middle.load(std::memory_order_acquire) & FreshBit);
+    }
+
+    // Consumer only. Makes the most recently published slot the Front().
+    // Returns: false, if nothing new was published; Front() is unchanged.
+    bool Acquire() noexcept
+    {
+        if (!HasFresh())
+        {
+            return false;
+        }
+
+        const auto previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & IndexMask;
+        return true;
+    }
+
+    // Consumer only.
+    const T& Front() const noexcept
+    {
+        return _slots[_front];
+    }
+
+    // Not copyable.
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator =(const TripleBuffer&) = delete;
+
+private:
+    static const std::uint32_t IndexMask = 0x3u;
+    static const std::uint32_t FreshBit = 0x4u;
+
+    std::array<T, 3> _slots;
+    std::uint32_t _back;                // Owned by the producer.
+    std::atomic<std::uint32_t> _middle; // Index of the handoff slot, and whether it's fresh.
+    std::uint32_t _front;               // Owned by the consumer.
+};
+
+
+#endif
@@ -0,0 +1,116 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+
+#include <SDL2/SDL.h>           // Primary SDL include for all platforms.
+#include <opengl/gl3.h>         // Probably specific to OS X.
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>          // Vector and Matrix math.
+
+#include "sdl.hpp"
+#include "gl_shader.hpp"
+#include "gl_program.hpp"
+#include "gl_state_cache.hpp"
+#include "gl_texture.hpp"
+#include "gl_framebuffer.hpp"
+#include "gl_vertex_array.hpp"
+#include "gl_startup.hpp"
+
+#include "wheel_cache.hpp"
+
+
+std::unique_ptr<gl::Program> CreateCompositeProgram()
+{
+    gl::Shader vertexShader(gl::ShaderType::Vertex);
+    vertexShader.Compile(LoadTextFile("composite.vert"));
+    if (!vertexShader.IsValid())
+    {
+        std::cout << vertexShader.GetCompilerOutput() << std::endl;
+        throw std::runtime_error("failed to compile the composite vertex shader");
+    }
+
+    gl::Shader fragmentShader(gl::ShaderType::Fragment);
+    fragmentShader.Compile(LoadTextFile("composite.frag"));
+    if (!fragmentShader.IsValid())
+    {
+        std::cout << fragmentShader.GetCompilerOutput() << std::endl;
+        throw std::runtime_error("failed to compile the composite fragment shader");
+    }
+
+    std::unique_ptr<gl::Program> pProgram(new gl::Program);
+    pProgram->Attach(vertexShader);
+    pProgram->Attach(fragmentShader);
+    pProgram->Link();
+    if (!pProgram->IsLinked())
+    {
+        std::cout << pProgram->GetLinkerOrValidationOutput() << std::endl;
+        throw std::runtime_error("failed to link the composite program");
+    }
+
+    return pProgram;
+}
+
+
+WheelCache::WheelCache(const glm::ivec2 drawableSize)
+    : _pCompositeProgram(CreateCompositeProgram())
+    , _textureLocation(_pCompositeProgram->GetUniformLocation("sourceTexture"))
+    , _savedViewport { 0, 0, drawableSize.x, drawableSize.y }
+    , _isValid(false)
+{
+    // The composite is a 1:1 copy of texels to pixels; no mipmaps or filtering between them.
+    _colorTexture.Storage(gl::TextureFormat::Rgba8, drawableSize.x, drawableSize.y);
+    _colorTexture.SetFilters(gl::TextureFilter::Nearest, gl::TextureFilter::Nearest);
+    _colorTexture.SetWrap(gl::TextureWrap::ClampToEdge, gl::TextureWrap::ClampToEdge);
+
+    _framebuffer.AttachColor(_colorTexture);
+    _framebuffer.Validate();
+    gl::Framebuffer::Unbind();
+}
+
+WheelCache::~WheelCache()
+{
+}
+
+void WheelCache::BeginCapture()
+{
+    ::glGetIntegerv(GL_VIEWPORT, _savedViewport);
+
+    _framebuffer.Bind();
+    ::glViewport(0, 0, _colorTexture.Width(), _colorTexture.Height());
+    ::glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    ::glClear(GL_COLOR_BUFFER_BIT);
+
+    // Accumulate coverage in alpha the way it'd be composited over the window, so the texture
+    // ends up holding premultiplied color.
+    ::glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void WheelCache::EndCapture()
+{
+    ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    gl::Framebuffer::Unbind();
+    ::glViewport(_savedViewport[0], _savedViewport[1], _savedViewport[2], _savedViewport[3]);
+    gl::VerifyNoErrors();
+
+    _isValid = true;
+}
+
+void WheelCache::Composite()
+{
+    auto& stateCache = gl::StateCache::Instance();
+
+    _pCompositeProgram->Use();
+    _pCompositeProgram->SetUniform(_textureLocation, 0);
+    stateCache.ActiveTexture(GL_TEXTURE0);
+    _colorTexture.Bind();
+    _emptyVertexArray.Bind();
+
+    ::glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    ::glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,72 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+#ifndef WHEEL_CACHE
+#define WHEEL_CACHE
+
+#include <memory>
+#include "gl_texture.hpp"
+#include "gl_framebuffer.hpp"
+#include "gl_vertex_array.hpp"
+#include "gl_shader.hpp"
+#include "gl_program.hpp"
+
+
+// Returns: a program that copies sourceTexture over the whole viewport (see composite.vert); draw a
+//          4 vertex triangle strip.
+// Throws:  std::runtime_error : either shader failed to compile; or, the program failed to link.
+std::unique_ptr<gl::Program> CreateCompositeProgram();
+
+
+// Render-to-texture cache of the color wheel.
+//
+// The wheel is rendered once into an offscreen color texture at the drawable (pixel) size and then
+// composited with a single full-viewport quad on every frame, until something that affects its
+// appearance changes and Invalidate() is called. This keeps the per-frame GPU cost constant,
+// regardless of how finely the wheel is tessellated, while nothing is animating.
+class WheelCache
+{
+public:
+    // Throws:  InvalidFramebufferOperation : the driver can't render to an RGBA8 texture.
+    //          std::runtime_error : the composite shader failed to compile or link.
+    explicit WheelCache(const glm::ivec2 drawableSize);
+    virtual ~WheelCache();
+
+    // Marks the cached image stale; the next frame must re-render the wheel.
+    void Invalidate() noexcept
+    {
+        _isValid = false;
+    }
+
+    // Returns: true, if the cached image can be composited as is.
+    bool IsValid() const noexcept
+    {
+        return _isValid;
+    }
+
+    // Redirects rendering into the offscreen texture and clears it to transparent black. The wheel
+    // should be drawn exactly as it would be into the default framebuffer.
+    void BeginCapture();
+
+    // Restores the default framebuffer and viewport; the cached image is valid again.
+    void EndCapture();
+
+    // Draws the cached image over the current viewport with premultiplied alpha blending.
+    void Composite();
+
+    // Not copyable.
+    WheelCache(const WheelCache&) = delete;
+    WheelCache& operator =(const WheelCache&) = delete;
+
+private:
+    gl::Texture _colorTexture;
+    gl::Framebuffer _framebuffer;
+    std::unique_ptr<gl::Program> _pCompositeProgram;
+    GLint _textureLocation;
+    gl::VertexArray _emptyVertexArray; // Core profile draws require one, even without attributes.
+    GLint _savedViewport[4];
+    bool _isValid;
+};
+
+
+#endif
@@ -0,0 +1,32 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+// Stand-in for <opengl/gl3.h> on platforms without the OS X framework layout; the benchmarks only
+// need the GL scalar types, never a GL function.
+
+#ifndef BENCH_COMPAT_GL3_H
+#define BENCH_COMPAT_GL3_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef unsigned int    GLenum;
+typedef unsigned char   GLboolean;
+typedef unsigned int    GLbitfield;
+typedef signed char     GLbyte;
+typedef short           GLshort;
+typedef int             GLint;
+typedef int             GLsizei;
+typedef unsigned char   GLubyte;
+typedef unsigned short  GLushort;
+typedef unsigned int    GLuint;
+typedef float           GLfloat;
+typedef double          GLdouble;
+typedef std::ptrdiff_t  GLintptr;
+typedef std::ptrdiff_t  GLsizeiptr;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+
+
+#endif
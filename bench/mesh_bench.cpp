@@ -0,0 +1,445 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+// Headless benchmark of the color wheel mesh and color generators.
+//
+// Runs every generator at every tessellation level and blend value without a window or GL
+// context, and reports ns/vertex, bytes written, and heap allocations per iteration as JSON.
+// Passing a previously saved report with --baseline turns it into a regression check.
+//
+// usage: mesh_bench [--json <file>] [--baseline <file>] [--tolerance <fraction>]
+//                   [--min-time-ms <ms>] [--blend-steps <n>] [--filter <substring>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "color_wheel_mesh.hpp"
+#include "gl_scratch.inl"
+
+#include "alloc_tracker.hpp"
+
+
+namespace
+{
+
+    typedef std::chrono::steady_clock clock;
+
+    struct Options
+    {
+        std::string jsonPath;
+        std::string baselinePath;
+        std::string filter;
+        double      tolerance = 0.10;
+        double      minTimeMs = 10.0;
+        int         blendSteps = 5;
+    };
+
+    struct Result
+    {
+        std::string     name;
+        std::size_t     vertices;           // Elements produced per iteration.
+        std::uint64_t   iterations;
+        double          nsPerVertex;
+        std::uint64_t   bytesWritten;       // Per iteration.
+        double          allocations;        // Per iteration.
+    };
+
+    // Keeps the optimizer from discarding generated data.
+    volatile float sink;
+
+    // Runs work until at least minTimeMs have elapsed (after one warm up call).
+    template<typename work_t>
+    Result Measure(
+        const Options& options,
+        const std::string& name,
+        const std::size_t vertices,
+        const std::size_t bytesPerVertex,
+        work_t&& work
+        )
+    {
+        work();
+
+        std::uint64_t iterations = 0u;
+        std::uint64_t batch = 1u;
+        const alloc_tracker::Scope allocationScope;
+        const auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+
+        while (std::chrono::duration<double, std::milli>(elapsed).count() < options.minTimeMs)
+        {
+            for (std::uint64_t i = 0u; i < batch; ++i)
+            {
+                work();
+            }
+            iterations += batch;
+            batch *= 2u;
+            elapsed = clock::now() - start;
+        }
+
+        const auto allocations = allocationScope.Elapsed().allocations;
+        const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+
+        Result result;
+        result.name = name;
+        result.vertices = vertices;
+        result.iterations = iterations;
+        result.nsPerVertex = ns / (static_cast<double>(iterations) * std::max<std::size_t>(vertices, 1u));
+        result.bytesWritten = static_cast<std::uint64_t>(vertices * bytesPerVertex);
+        result.allocations = static_cast<double>(allocations) / iterations;
+        return result;
+    }
+
+    bool IsSelected(const Options& options, const std::string& name)
+    {
+        return options.filter.empty() || std::string::npos != name.find(options.filter);
+    }
+
+    std::string Name(const char* const generator, const int hues, const int saturations)
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%s/h%d/s%d", generator, hues, saturations);
+        return text;
+    }
+
+    std::string Name(const char* const generator, const int hues, const int saturations, const float t)
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%s/h%d/s%d/t%.2f", generator, hues, saturations, t);
+        return text;
+    }
+
+    void RunMeshBenchmarks(const Options& options, std::vector<Result>& results)
+    {
+        const auto MaxVertices = ColorCountForTessellation(MaxHueTessellations) *
+            SaturationCountForTessellation(MaxSaturationTessellations) * 4;
+
+        std::vector<glm::vec2> verts(MaxVertices);
+        std::vector<glm::vec3> colors(MaxVertices);
+        std::vector<float> saturation(MaxVertices);
+        std::vector<int> trackStartPositions(SaturationCountForTessellation(MaxSaturationTessellations));
+        std::vector<int> trackIndiceCounts(SaturationCountForTessellation(MaxSaturationTessellations));
+
+        const auto steps = std::max(options.blendSteps, 2);
+
+        for (auto h = 0; h <= MaxHueTessellations; ++h)
+        {
+            const auto colorCount = ColorCountForTessellation(h);
+
+            for (auto s = 0; s <= MaxSaturationTessellations; ++s)
+            {
+                const auto trackCount = SaturationCountForTessellation(s);
+                const std::size_t vertices = colorCount * trackCount * 4;
+
+                auto name = Name("colors", colorCount, trackCount);
+                if (IsSelected(options, name))
+                {
+                    results.push_back(Measure(options, name, vertices, sizeof(glm::vec3), [&]
+                    {
+                        CreateColorWheelColors(colorCount, trackCount, RgbColorModel, std::begin(colors));
+                        sink = colors[vertices - 1].r;
+                    }));
+                }
+
+                name = Name("indices", colorCount, trackCount);
+                if (IsSelected(options, name))
+                {
+                    results.push_back(Measure(options, name, trackCount, 2u * sizeof(int), [&]
+                    {
+                        RecalculateIndices(colorCount, trackCount, trackStartPositions, trackIndiceCounts);
+                        sink = static_cast<float>(trackStartPositions[trackCount - 1]);
+                    }));
+                }
+
+                for (auto step = 0; step < steps; ++step)
+                {
+                    const auto t = static_cast<float>(step) / (steps - 1);
+
+                    name = Name("geometry", colorCount, trackCount, t);
+                    if (IsSelected(options, name))
+                    {
+                        results.push_back(Measure(options, name, vertices, sizeof(glm::vec2), [&]
+                        {
+                            CreateColorWheelGeometry(
+                                colorCount,
+                                trackCount,
+                                WheelInnerRadius,
+                                t,
+                                t,
+                                std::begin(verts)
+                                );
+                            sink = verts[vertices - 1].x;
+                        }));
+                    }
+
+                    name = Name("saturation", colorCount, trackCount, t);
+                    if (IsSelected(options, name))
+                    {
+                        results.push_back(Measure(options, name, vertices, sizeof(float), [&]
+                        {
+                            CreateColorWheelSaturation(colorCount, trackCount, t, std::begin(saturation));
+                            sink = saturation[vertices - 1];
+                        }));
+                    }
+                }
+            }
+        }
+    }
+
+    void RunHueBenchmarks(const Options& options, std::vector<Result>& results)
+    {
+        const auto Samples = 4096;
+
+        const auto run = [&](const char* const name, const double (&colorModel)[3 * 6])
+        {
+            if (!IsSelected(options, name))
+            {
+                return;
+            }
+
+            results.push_back(Measure(options, name, Samples, sizeof(glm::dvec3), [&]
+            {
+                glm::dvec3 color;
+                double sum = 0.0;
+                for (auto i = 0; i < Samples; ++i)
+                {
+                    CalculateHueForColorModel(trig::TwoPi * i / Samples, colorModel, color);
+                    sum += color.r;
+                }
+                sink = static_cast<float>(sum);
+            }));
+        };
+
+        run("hue/rgb", RgbColorModel);
+        run("hue/ryb", RybColorModel);
+    }
+
+    // The bool to GLint conversion behind uniform and buffer object uploads of bool data; once
+    // warmed up it shouldn't allocate.
+    void RunBoolConversionBenchmarks(const Options& options, std::vector<Result>& results)
+    {
+        for (const std::size_t count : { 16u, 64u, 4096u, 65536u })
+        {
+            char name[64];
+            std::snprintf(name, sizeof(name), "bool_to_glint/n%zu", count);
+            if (!IsSelected(options, name))
+            {
+                continue;
+            }
+
+            const std::vector<bool> values(count, true);
+            results.push_back(Measure(options, name, count, sizeof(GLint), [&]
+            {
+                gl::impl::detail::GLintScratch scratch(values.size());
+                auto* const pInts = scratch.data();
+                for (std::size_t i = 0u; i < values.size(); ++i)
+                {
+                    pInts[i] = values[i] ? GL_TRUE : GL_FALSE;
+                }
+                sink = static_cast<float>(pInts[count - 1]);
+            }));
+        }
+    }
+
+    void WriteJson(std::ostream& out, const std::vector<Result>& results)
+    {
+        // One benchmark per line keeps the baseline reader trivial.
+        out << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0u; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            char line[512];
+            std::snprintf(
+                line,
+                sizeof(line),
+                "    {\"name\": \"%s\", \"vertices\": %zu, \"iterations\": %llu, "
+                "\"ns_per_vertex\": %.4f, \"bytes_written\": %llu, \"allocations\": %.4f}%s\n",
+                r.name.c_str(),
+                r.vertices,
+                static_cast<unsigned long long>(r.iterations),
+                r.nsPerVertex,
+                static_cast<unsigned long long>(r.bytesWritten),
+                r.allocations,
+                (i + 1u < results.size()) ? "," : ""
+                );
+            out << line;
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Reads a report written by WriteJson().
+    // Returns: name -> result; only name, ns_per_vertex, and allocations are filled in.
+    std::map<std::string, Result> ReadBaseline(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("can't open baseline: " + path);
+        }
+
+        std::map<std::string, Result> baseline;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            char name[256];
+            Result r {};
+            const auto* const pName = std::strstr(line.c_str(), "\"name\": \"");
+            const auto* const pNs = std::strstr(line.c_str(), "\"ns_per_vertex\": ");
+            const auto* const pAllocations = std::strstr(line.c_str(), "\"allocations\": ");
+            if (nullptr == pName || nullptr == pNs || nullptr == pAllocations ||
+                1 != std::sscanf(pName, "\"name\": \"%255[^\"]\"", name) ||
+                1 != std::sscanf(pNs, "\"ns_per_vertex\": %lf", &r.nsPerVertex) ||
+                1 != std::sscanf(pAllocations, "\"allocations\": %lf", &r.allocations))
+            {
+                continue;
+            }
+            r.name = name;
+            baseline[r.name] = r;
+        }
+        return baseline;
+    }
+
+    // Returns: the number of regressions: benchmarks slower than the baseline by more than the
+    //              tolerance, or that allocate more.
+    int CompareToBaseline(const Options& options, const std::vector<Result>& results)
+    {
+        const auto baseline = ReadBaseline(options.baselinePath);
+
+        auto regressions = 0;
+        for (const auto& r : results)
+        {
+            const auto it = baseline.find(r.name);
+            if (baseline.end() == it)
+            {
+                continue;
+            }
+
+            const auto& b = it->second;
+            const auto isSlower = r.nsPerVertex > b.nsPerVertex * (1.0 + options.tolerance);
+            const auto allocatesMore = r.allocations > b.allocations;
+            if (isSlower || allocatesMore)
+            {
+                ++regressions;
+                std::fprintf(
+                    stderr,
+                    "REGRESSION %-32s %8.3f ns/vertex (baseline %8.3f, %+.1f%%)  %.2f allocations (baseline %.2f)\n",
+                    r.name.c_str(),
+                    r.nsPerVertex,
+                    b.nsPerVertex,
+                    100.0 * (r.nsPerVertex / b.nsPerVertex - 1.0),
+                    r.allocations,
+                    b.allocations
+                    );
+            }
+        }
+
+        std::fprintf(
+            stderr,
+            "%d regression(s) against %s (tolerance %.0f%%)\n",
+            regressions,
+            options.baselinePath.c_str(),
+            100.0 * options.tolerance
+            );
+        return regressions;
+    }
+
+    bool ParseArguments(const int argc, char* argv[], Options& options)
+    {
+        for (auto i = 1; i < argc; ++i)
+        {
+            const std::string arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            if ("--json" == arg && hasValue)
+            {
+                options.jsonPath = argv[++i];
+            }
+            else if ("--baseline" == arg && hasValue)
+            {
+                options.baselinePath = argv[++i];
+            }
+            else if ("--tolerance" == arg && hasValue)
+            {
+                options.tolerance = std::atof(argv[++i]);
+            }
+            else if ("--min-time-ms" == arg && hasValue)
+            {
+                options.minTimeMs = std::atof(argv[++i]);
+            }
+            else if ("--blend-steps" == arg && hasValue)
+            {
+                options.blendSteps = std::atoi(argv[++i]);
+            }
+            else if ("--filter" == arg && hasValue)
+            {
+                options.filter = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::fprintf(
+            stderr,
+            "usage: %s [--json <file>] [--baseline <file>] [--tolerance <fraction>]\n"
+            "          [--min-time-ms <ms>] [--blend-steps <n>] [--filter <substring>]\n",
+            argv[0]
+            );
+        return 2;
+    }
+
+    try
+    {
+        std::vector<Result> results;
+        results.reserve(1024u);
+
+        RunMeshBenchmarks(options, results);
+        RunHueBenchmarks(options, results);
+        RunBoolConversionBenchmarks(options, results);
+
+        if (options.jsonPath.empty())
+        {
+            WriteJson(std::cout, results);
+        }
+        else
+        {
+            std::ofstream out(options.jsonPath);
+            WriteJson(out, results);
+        }
+
+        if (!options.baselinePath.empty() && 0 != CompareToBaseline(options, results))
+        {
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+// Prebakes the GUI font atlas.
+//
+// Rasterizes printable ASCII at each pixel size, packs the glyphs on shelves exactly as the imgui
+// renderer's allocator would have, and writes the atlas rows (PackBits compressed), the shelves,
+// and the glyph metrics as a C++ include for imguiRenderGL3.cpp. At startup the renderer copies
+// them into its atlas instead of reading and rasterizing the TTF; anything else (other sizes,
+// other characters, or a different font file) is still rasterized on demand.
+//
+// usage: font_bake <font.ttf> <output.inc> [<pixel size>...]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "stb_truetype.h"
+
+
+namespace
+{
+
+    // These must match imguiRenderGL3.cpp, which checks them.
+    const int AtlasSize = 512;
+    const int AtlasPadding = 1;
+    const int AtlasReservedRows = 4;
+    const int DefaultPixelSizes[] = { 15, 30 };     // FONT_SIZE at 1x and 2x drawable scales.
+
+    struct Shelf
+    {
+        int y;
+        int height;
+        int x;
+    };
+
+    struct Glyph
+    {
+        unsigned codepoint;
+        int pixelSize;
+        int x, y;
+        int w, h;
+        int xoff, yoff;
+        float xadvance;
+        int slotW;
+        int shelf;
+    };
+
+    struct Atlas
+    {
+        std::vector<unsigned char> pixels;
+        std::vector<Shelf> shelves;
+        std::vector<Glyph> glyphs;
+        int shelfBottom;
+    };
+
+    // Throws:  std::runtime_error : the file can't be read.
+    std::vector<unsigned char> ReadFile(const char* const pPath)
+    {
+        FILE* const pFile = std::fopen(pPath, "rb");
+        if (nullptr == pFile)
+        {
+            throw std::runtime_error(std::string("can't open ") + pPath);
+        }
+
+        std::vector<unsigned char> contents;
+        unsigned char buffer[4096];
+        std::size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        {
+            contents.insert(contents.end(), buffer, buffer + count);
+        }
+        std::fclose(pFile);
+        return contents;
+    }
+
+    // The renderer's allocator, for an atlas that is only ever appended to.
+    // Throws:  std::runtime_error : the atlas is full.
+    void AllocateSlot(Atlas& atlas, Glyph& glyph)
+    {
+        const int slotW = glyph.w + AtlasPadding;
+        const int slotH = (glyph.h + AtlasPadding + 3) & ~3;
+
+        for (std::size_t i = 0; i < atlas.shelves.size(); ++i)
+        {
+            Shelf& shelf = atlas.shelves[i];
+            if (shelf.height == slotH && shelf.x + slotW <= AtlasSize)
+            {
+                glyph.x = shelf.x;
+                glyph.y = shelf.y;
+                glyph.slotW = slotW;
+                glyph.shelf = static_cast<int>(i);
+                shelf.x += slotW;
+                return;
+            }
+        }
+
+        if (atlas.shelfBottom + slotH > AtlasSize - AtlasReservedRows)
+        {
+            throw std::runtime_error("the glyphs don't fit in the atlas");
+        }
+
+        const Shelf shelf = { atlas.shelfBottom, slotH, AtlasPadding + slotW };
+        glyph.x = AtlasPadding;
+        glyph.y = atlas.shelfBottom;
+        glyph.slotW = slotW;
+        glyph.shelf = static_cast<int>(atlas.shelves.size());
+        atlas.shelves.push_back(shelf);
+        atlas.shelfBottom += slotH;
+    }
+
+    // Throws:  std::runtime_error : the atlas is full.
+    void BakeGlyph(const stbtt_fontinfo& font, Atlas& atlas, const unsigned codepoint, const int pixelSize)
+    {
+        const float scale = stbtt_ScaleForPixelHeight(&font, static_cast<float>(pixelSize));
+        int advance, lsb;
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointHMetrics(&font, static_cast<int>(codepoint), &advance, &lsb);
+        stbtt_GetCodepointBitmapBox(&font, static_cast<int>(codepoint), scale, scale, &x0, &y0, &x1, &y1);
+
+        Glyph glyph = { codepoint, pixelSize, 0, 0, x1 - x0, y1 - y0, x0, y0, scale * static_cast<float>(advance), 0, -1 };
+        if (glyph.w > 0 && glyph.h > 0)
+        {
+            AllocateSlot(atlas, glyph);
+            stbtt_MakeCodepointBitmap(&font, &atlas.pixels[glyph.y * AtlasSize + glyph.x], glyph.w, glyph.h,
+                                      AtlasSize, scale, scale, static_cast<int>(codepoint));
+        }
+        atlas.glyphs.push_back(glyph);
+    }
+
+    // PackBits: a header byte n below 128 is followed by n + 1 literal bytes; above 128, by one
+    // byte repeated 257 - n times.
+    std::vector<unsigned char> PackBits(const unsigned char* const pData, const std::size_t size)
+    {
+        std::vector<unsigned char> packed;
+        std::size_t i = 0;
+        while (i < size)
+        {
+            std::size_t run = 1;
+            while (i + run < size && run < 128 && pData[i + run] == pData[i])
+            {
+                ++run;
+            }
+            if (run >= 3)
+            {
+                packed.push_back(static_cast<unsigned char>(257 - run));
+                packed.push_back(pData[i]);
+                i += run;
+                continue;
+            }
+
+            // Literals, until a run of three is worth breaking for.
+            std::size_t count = 0;
+            while (i + count < size && count < 128)
+            {
+                if (i + count + 2 < size && pData[i + count] == pData[i + count + 1] &&
+                    pData[i + count] == pData[i + count + 2])
+                {
+                    break;
+                }
+                ++count;
+            }
+            packed.push_back(static_cast<unsigned char>(count - 1));
+            packed.insert(packed.end(), pData + i, pData + i + count);
+            i += count;
+        }
+        return packed;
+    }
+
+    // Throws:  std::runtime_error : the file can't be written.
+    void WriteInclude(const char* const pPath, const char* const pFontName, const std::size_t fontSize, const Atlas& atlas)
+    {
+        FILE* const pFile = std::fopen(pPath, "w");
+        if (nullptr == pFile)
+        {
+            throw std::runtime_error(std::string("can't create ") + pPath);
+        }
+
+        const std::size_t bakedSize = static_cast<std::size_t>(atlas.shelfBottom) * AtlasSize;
+        const std::vector<unsigned char> packed = PackBits(atlas.pixels.data(), bakedSize);
+
+        std::fprintf(pFile, "// Generated by tools/font_bake from %s; don't edit. Rebuild it with: make -C tools font\n\n", pFontName);
+        std::fprintf(pFile, "static const char BAKED_FONT_NAME[] = \"%s\";\n", pFontName);
+        std::fprintf(pFile, "static const long BAKED_FONT_FILE_SIZE = %lu;\n", static_cast<unsigned long>(fontSize));
+        std::fprintf(pFile, "static const int BAKED_FONT_ATLAS_SIZE = %d;\n", AtlasSize);
+        std::fprintf(pFile, "static const int BAKED_FONT_ATLAS_PADDING = %d;\n", AtlasPadding);
+        std::fprintf(pFile, "static const int BAKED_FONT_SHELF_BOTTOM = %d;\n\n", atlas.shelfBottom);
+
+        std::fprintf(pFile, "static const imguiShelf BAKED_FONT_SHELVES[] =\n{\n");
+        for (const Shelf& shelf : atlas.shelves)
+        {
+            std::fprintf(pFile, "        { %d, %d, %d },\n", shelf.y, shelf.height, shelf.x);
+        }
+        std::fprintf(pFile, "};\n\n");
+
+        std::fprintf(pFile, "static const imguiBakedGlyph BAKED_FONT_GLYPHS[] =\n{\n");
+        for (const Glyph& glyph : atlas.glyphs)
+        {
+            std::fprintf(pFile, "        { %u, %d, %d, %d, %d, %d, %d, %d, %.9gf, %d, %d },\n",
+                         glyph.codepoint, glyph.pixelSize, glyph.x, glyph.y, glyph.w, glyph.h,
+                         glyph.xoff, glyph.yoff, glyph.xadvance, glyph.slotW, glyph.shelf);
+        }
+        std::fprintf(pFile, "};\n\n");
+
+        std::fprintf(pFile, "// %lu atlas rows, PackBits compressed from %lu bytes.\n",
+                     static_cast<unsigned long>(atlas.shelfBottom), static_cast<unsigned long>(bakedSize));
+        std::fprintf(pFile, "static const unsigned char BAKED_FONT_ROWS[] =\n{");
+        for (std::size_t i = 0; i < packed.size(); ++i)
+        {
+            std::fprintf(pFile, "%s%u,", i % 24 ? " " : "\n        ", packed[i]);
+        }
+        std::fprintf(pFile, "\n};\n");
+
+        const bool isWritten = 0 == std::ferror(pFile);
+        if (0 != std::fclose(pFile) || !isWritten)
+        {
+            throw std::runtime_error(std::string("can't write ") + pPath);
+        }
+    }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: font_bake <font.ttf> <output.inc> [<pixel size>...]\n");
+        return 2;
+    }
+
+    try
+    {
+        std::vector<int> pixelSizes;
+        for (int i = 3; i < argc; ++i)
+        {
+            const int size = std::atoi(argv[i]);
+            if (size < 1 || size > 255)
+            {
+                throw std::runtime_error(std::string("bad pixel size ") + argv[i]);
+            }
+            pixelSizes.push_back(size);
+        }
+        if (pixelSizes.empty())
+        {
+            pixelSizes.assign(std::begin(DefaultPixelSizes), std::end(DefaultPixelSizes));
+        }
+
+        const std::vector<unsigned char> ttf = ReadFile(argv[1]);
+        stbtt_fontinfo font;
+        if (ttf.empty() || !stbtt_InitFont(&font, ttf.data(), stbtt_GetFontOffsetForIndex(ttf.data(), 0)))
+        {
+            throw std::runtime_error(std::string("can't parse ") + argv[1]);
+        }
+
+        Atlas atlas;
+        atlas.pixels.assign(static_cast<std::size_t>(AtlasSize) * AtlasSize, 0);
+        atlas.shelfBottom = AtlasPadding;
+        for (const int pixelSize : pixelSizes)
+        {
+            for (unsigned codepoint = 32; codepoint < 127; ++codepoint)
+            {
+                BakeGlyph(font, atlas, codepoint, pixelSize);
+            }
+        }
+
+        const char* pFontName = std::strrchr(argv[1], '/');
+        pFontName = pFontName ? pFontName + 1 : argv[1];
+        WriteInclude(argv[2], pFontName, ttf.size(), atlas);
+        std::printf("%s: %lu glyphs in %d atlas rows\n", argv[2],
+                    static_cast<unsigned long>(atlas.glyphs.size()), atlas.shelfBottom);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "font_bake: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
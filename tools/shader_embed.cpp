@@ -0,0 +1,100 @@
+//  Copyright (c) 2016 Christopher Gassib. All rights reserved.
+//
+
+// Embeds the shader sources.
+//
+// Writes each file as a constexpr raw string literal, plus a table of them by file name, as a C++
+// include for gl_startup.cpp; LoadTextFile() then needs no file I/O at startup.
+//
+// usage: shader_embed <output.inc> <shader>...
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+    const char Delimiter[] = "glsl";
+
+    // Throws:  std::runtime_error : the file can't be read.
+    std::string ReadFile(const char* const pPath)
+    {
+        FILE* const pFile = std::fopen(pPath, "rb");
+        if (nullptr == pFile)
+        {
+            throw std::runtime_error(std::string("can't open ") + pPath);
+        }
+
+        std::string contents;
+        char buffer[4096];
+        std::size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        {
+            contents.append(buffer, count);
+        }
+        std::fclose(pFile);
+        return contents;
+    }
+
+    const char* FileName(const char* const pPath)
+    {
+        const char* const pSlash = std::strrchr(pPath, '/');
+        return pSlash ? pSlash + 1 : pPath;
+    }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: shader_embed <output.inc> <shader>...\n");
+        return 2;
+    }
+
+    try
+    {
+        std::string output("// Generated by tools/shader_embed; don't edit. Rebuild it with: make -C tools shaders\n\n");
+        std::string table("constexpr EmbeddedText EmbeddedShaders[] =\n{\n");
+        for (int i = 2; i < argc; ++i)
+        {
+            // Line endings inside raw strings are up to the compiler; write them as LF.
+            std::string source = ReadFile(argv[i]);
+            source.erase(std::remove(source.begin(), source.end(), '\r'), source.end());
+            if (std::string::npos != source.find(std::string(")") + Delimiter + "\""))
+            {
+                throw std::runtime_error(std::string(argv[i]) + " contains the raw string delimiter");
+            }
+
+            const std::string name = "EmbeddedShader" + std::to_string(i - 2);
+            output += "constexpr char " + name + "[] = R\"" + Delimiter + "(" + source + ")" + Delimiter + "\";\n\n";
+            table += std::string("    { \"") + FileName(argv[i]) + "\", " + name + ", sizeof(" + name + ") - 1u },\n";
+        }
+        output += table + "};\n";
+
+        FILE* const pFile = std::fopen(argv[1], "wb");
+        if (nullptr == pFile)
+        {
+            throw std::runtime_error(std::string("can't create ") + argv[1]);
+        }
+        const bool isWritten = output.size() == std::fwrite(output.data(), 1, output.size(), pFile);
+        if (0 != std::fclose(pFile) || !isWritten)
+        {
+            throw std::runtime_error(std::string("can't write ") + argv[1]);
+        }
+        std::printf("%s: %d shaders\n", argv[1], argc - 2);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "shader_embed: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}